@@ -0,0 +1,78 @@
+// Actuate.c
+// Runs on MSP432
+// Fixed-rate actuation from a double-buffered command.
+// Actuate_Command fills the slot the ISR is not looking at and
+// then publishes it with one word write, so the ISR only ever
+// sees a whole command.  The ISR preempts the main loop, never
+// the other way around, so no critical section is needed.
+
+#include <stdint.h>
+#include "msp.h"
+#include "Actuate.h"
+#include "Motor.h"
+#include "RamFunc.h"
+#include "Trace.h"
+
+#define TIMER_CLOCK 1500000       // SMCLK 12 MHz divided by 8
+
+typedef struct {
+  int16_t left;
+  int16_t right;
+  uint8_t mode;
+} Command_t;
+
+static Command_t Slot[2];
+static volatile uint32_t Published;   // index of the newest complete slot
+static volatile uint32_t Fresh;       // 1 until the ISR applies it
+
+void Actuate_Init(void){
+  Published = 0;
+  Fresh = 0;
+  TIMER_A1->CTL &= ~0x0030;           // halt Timer A1
+  TIMER_A1->CCTL[0] = 0x0010;         // compare mode, arm CCIFG
+  TIMER_A1->CCR[0] = TIMER_CLOCK/ACTUATE_HZ - 1;
+  TIMER_A1->EX0 = 0;                  // divide by 1
+  NVIC->IP[10] = 0x40;                // TA1_0 is interrupt 10, priority 2
+  NVIC->ISER[0] = 0x00000400;         // enable interrupt 10 in NVIC
+  TIMER_A1->CTL = 0x02D4;             // SMCLK, divide by 8, clear, up mode
+// bit  mode
+// 9-8  10    TASSEL, SMCLK=12MHz
+// 7-6  11    ID, divide by 8
+// 5-4  01    MC, up mode
+// 2    1     TACLR, clear
+// 1    0     TAIE, no interrupt
+// 0          TAIFG
+}
+
+RAMFUNC void Actuate_Command(int16_t leftDuty, int16_t rightDuty, uint8_t mode){
+  uint32_t next = Published^1;
+  Slot[next].left = leftDuty;
+  Slot[next].right = rightDuty;
+  Slot[next].mode = mode;
+  Published = next;                   // complete, hand it over
+  Fresh = 1;
+}
+
+void Actuate_Halt(void){
+  TIMER_A1->CCTL[0] &= ~0x0011;       // disarm, drop a pending tick
+  Fresh = 0;
+}
+
+// Runs every 1/ACTUATE_HZ s
+RAMFUNC void TA1_0_IRQHandler(void){
+  const Command_t *c;
+  TRACE_ENTER(TRACE_TA1);
+  TIMER_A1->CCTL[0] &= ~0x0001;       // acknowledge
+  if(Fresh){
+    Fresh = 0;
+    c = &Slot[Published];
+    if(c->mode == ACTUATE_STOP){
+      Motor_Stop();
+    }else if(c->mode == ACTUATE_SPEED){
+      Motor_Speed(c->left, c->right);
+    }else{
+      Motor_Drive(c->left, c->right);
+    }
+  }
+  TRACE_EXIT(TRACE_TA1);
+}
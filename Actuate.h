@@ -0,0 +1,49 @@
+// Actuate.h
+// Runs on MSP432
+// Fixed-rate actuation.  The control loop posts a motor command
+// whenever it decides one, and TimerA1 applies the newest
+// complete command at ACTUATE_HZ.  The time from a decision to
+// the motors is then at most one tick, whatever the dwell or
+// classification time of the loop.
+// Uses TimerA1 CCR0 interrupt, priority 2.
+
+#ifndef ACTUATE_H_
+#define ACTUATE_H_
+#include <stdint.h>
+
+// Latch rate, override with --define=ACTUATE_HZ= (23 to 100,000 Hz)
+#ifndef ACTUATE_HZ
+#define ACTUATE_HZ 1000
+#endif
+
+#define ACTUATE_DRIVE 0           // Motor_Drive(left, right), (0,0) brakes
+#define ACTUATE_STOP 1            // Motor_Stop, drivers asleep
+#define ACTUATE_SPEED 2           // Motor_Speed(left, right) in mm/s
+
+// ------------Actuate_Init------------
+// Start TimerA1 latching commands at ACTUATE_HZ.  Nothing is
+// applied until the first Actuate_Command.
+// Input: none
+// Output: none
+// Assumes: Motor_Init() has been called
+void Actuate_Init(void);
+
+// ------------Actuate_Command------------
+// Post a command for the next tick.  A newer command posted
+// before the tick replaces it.  After Actuate_Init only the
+// TimerA1 ISR should call the Motor_ functions.
+// Input: leftDuty  signed duty of left wheel (-14,999 to 14,999),
+//                  or mm/s for ACTUATE_SPEED
+//        rightDuty signed duty of right wheel, the same
+//        mode      ACTUATE_DRIVE, ACTUATE_STOP or ACTUATE_SPEED
+// Output: none
+void Actuate_Command(int16_t leftDuty, int16_t rightDuty, uint8_t mode);
+
+// ------------Actuate_Halt------------
+// Stop latching commands for good, for a fail-safe.  Commands
+// posted later are ignored.
+// Input: none
+// Output: none
+void Actuate_Halt(void);
+
+#endif
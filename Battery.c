@@ -0,0 +1,100 @@
+// Battery.c
+// Runs on MSP432
+// Battery voltage on ADC14 channel 12 (P4.1).
+// 14-bit single conversions against AVCC (3.3 V), software
+// started, SMCLK 12 MHz, 32-clock sample.  Nothing else uses
+// the ADC, so no interrupt: the result waits in MEM[0].
+// Filtered voltage is kept in mV*16, a first-order low-pass
+//   y = y + (x - y)/16
+
+#include <stdint.h>
+#include "msp.h"
+#include "Battery.h"
+#include "Motor.h"
+
+#define BATTERY_AVCC_MV 3300
+
+static uint32_t Filtered;         // mV*16, 0 before the first reading
+static uint32_t State;
+static uint32_t Countdown;
+
+void Battery_Init(void){
+  Filtered = 0;
+  State = BATTERY_OK;
+  Countdown = BATTERY_PERIOD_MS;
+#ifdef BATTERY_DIVIDER
+  P4->SEL0 |= 0x02;
+  P4->SEL1 |= 0x02;                   // P4.1 analog, A12
+  ADC14->CTL0 &= ~0x00000002;         // ENC off to configure
+  ADC14->CTL0 = 0x04200310;
+// bit  mode
+// 26   1     SHP, sample timer
+// 21-19 100  SSEL, SMCLK
+// 11-8 0011  SHT0, 32 clocks
+// 4    1     ON
+  ADC14->CTL1 = 0x00000030;           // 14-bit, results into MEM[0]
+  ADC14->MCTL[0] = 12;                // A12, AVCC to AVSS
+  ADC14->IER0 = 0;                    // polled
+  ADC14->CTL0 |= 0x00000003;          // ENC and SC, first conversion
+#endif
+}
+
+uint32_t Battery_Tick(void){
+#ifdef BATTERY_DIVIDER
+  uint32_t mV;
+  Countdown--;
+  if(Countdown){
+    return 0;
+  }
+  Countdown = BATTERY_PERIOD_MS;
+  if((ADC14->IFGR0&0x01) == 0){
+    ADC14->CTL0 |= 0x00000001;        // lost one somehow, start again
+    return 0;
+  }
+  mV = (ADC14->MEM[0]*BATTERY_AVCC_MV*BATTERY_DIVIDER)>>14; // reading clears IFG0
+  ADC14->CTL0 |= 0x00000001;          // SC, next conversion
+  if(mV < BATTERY_ABSENT_MV){
+    return 0;                         // the robot could not run on this, no divider
+  }
+  if(Filtered == 0){
+    Filtered = mV*16;                 // first reading, nothing to filter yet
+  }else{
+    Filtered = Filtered + mV - Filtered/16;
+  }
+  mV = Filtered/16;
+  if(mV < BATTERY_CUTOFF_MV){
+    State = BATTERY_CUTOFF;
+  }else if(State == BATTERY_OK){
+    if(mV < BATTERY_LOW_MV){
+      State = BATTERY_LOW;
+    }
+  }else if(State == BATTERY_LOW){
+    if(mV > BATTERY_LOW_MV + BATTERY_HYSTERESIS_MV){
+      State = BATTERY_OK;               // recovered, the load sag had it
+    }
+  }
+  return 1;
+#else
+  return 0;                           // nothing to read
+#endif
+}
+
+uint32_t Battery_Millivolts(void){
+  return Filtered/16;
+}
+
+uint32_t Battery_State(void){
+  return State;
+}
+
+uint32_t Battery_Limit(void){
+  uint32_t mV = Filtered/16;
+  uint32_t limit = MOTOR_DUTY_FULL;
+  if(mV && (mV < BATTERY_NOMINAL_MV)){
+    limit = MOTOR_DUTY_FULL*mV/BATTERY_NOMINAL_MV;
+  }
+  if((State != BATTERY_OK) && (limit > BATTERY_LOW_DUTY)){
+    limit = BATTERY_LOW_DUTY;
+  }
+  return limit;
+}
@@ -0,0 +1,65 @@
+// Battery.h
+// Runs on MSP432
+// Battery voltage on ADC14, for duty compensation and a
+// low-battery governor.  The chassis board does not route VBAT
+// to an ADC pin, so all of it is off unless a divider from VBAT
+// to P4.1/A12 is fitted and the build says so with its ratio,
+// --define=BATTERY_DIVIDER=3 for 3:1.  Without it P4.1 floats,
+// and a floating pin can read as a flat pack and stop the robot.
+// Off, Battery_Millivolts is 0, the state stays BATTERY_OK and
+// the duties are not scaled.
+// The sensing task calls Battery_Tick every 1 ms.  Every
+// BATTERY_PERIOD_MS it collects the last conversion and starts
+// the next, so it never waits on the ADC.  Readings are low-pass
+// filtered over about 16 samples, which rides out the sag of a
+// PWM pulse but follows the pack as it drains.
+
+#ifndef BATTERY_H_
+#define BATTERY_H_
+#include <stdint.h>
+
+#define BATTERY_PERIOD_MS 10      // between conversions
+
+// Pack voltages, mV, six NiMH cells
+// override with --define=BATTERY_NOMINAL_MV=
+#ifndef BATTERY_NOMINAL_MV
+#define BATTERY_NOMINAL_MV 7200   // the FSM duties were tuned here
+#endif
+#define BATTERY_LOW_MV 6600       // limp: cap the duty
+#define BATTERY_CUTOFF_MV 6000    // stop for good, protects the cells
+#define BATTERY_HYSTERESIS_MV 200 // to leave BATTERY_LOW
+#define BATTERY_LOW_DUTY 7000     // duty cap while low (of 15,000)
+#define BATTERY_ABSENT_MV 3000    // below this no divider is fitted, ignored
+
+#define BATTERY_OK 0
+#define BATTERY_LOW 1
+#define BATTERY_CUTOFF 2
+
+// ------------Battery_Init------------
+// Set up ADC14 on P4.1/A12 and start the first conversion
+// Input: none
+// Output: none
+void Battery_Init(void);
+
+// ------------Battery_Tick------------
+// Collect and filter a finished conversion, start the next
+// Input: none
+// Output: 1 if the filtered voltage was updated
+uint32_t Battery_Tick(void);
+
+// ------------Battery_Millivolts------------
+// Output: filtered pack voltage, mV, 0 before the first reading
+uint32_t Battery_Millivolts(void);
+
+// ------------Battery_State------------
+// Output: BATTERY_OK, BATTERY_LOW or BATTERY_CUTOFF;
+// BATTERY_CUTOFF stays until reset
+uint32_t Battery_State(void);
+
+// ------------Battery_Limit------------
+// Largest duty the pack can hold at the nominal motor voltage,
+// and no more than BATTERY_LOW_DUTY while low
+// Output: 0 to MOTOR_DUTY_FULL
+uint32_t Battery_Limit(void);
+
+#endif
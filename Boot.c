@@ -0,0 +1,60 @@
+// Boot.c
+// Runs on MSP432
+// Boot-phase timestamps on the DWT cycle counter.
+// A phase that changes the clock is counted at the rate it
+// started with; Clock_Init48MHz spends nearly all its time
+// waiting for the crystal, at 3 MHz.  The magic word is random
+// at power-on, so a cold boot starts a new record.
+
+#include <stdint.h>
+#include "msp.h"
+#include "Boot.h"
+
+#define BOOT_MAGIC 0xB0075AFE
+
+#pragma NOINIT(Boot)
+Boot_t Boot;
+
+void Boot_Start(void){
+  uint32_t i;
+  CoreDebug->DEMCR |= 0x01000000;       // TRCENA, turn on the DWT
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= 0x00000001;              // CYCCNTENA, count cycles
+  if(Boot.magic == BOOT_MAGIC){
+    Boot.restarts++;
+    Boot.warm = Boot.moving;
+  }else{
+    Boot.magic = BOOT_MAGIC;
+    Boot.restarts = 0;
+    Boot.warm = 0;
+  }
+  Boot.moving = 0;
+  Boot.phase = BOOT_SYSTEM;
+  Boot.mhz = 3;                         // DCO at reset
+  Boot.last = 0;
+  for(i = 0; i < BOOT_PHASES; i++){
+    Boot.us[i] = 0;
+  }
+}
+
+void Boot_Mark(uint32_t phase){
+  uint32_t now = DWT->CYCCNT;
+  if((phase < Boot.phase) || (phase >= BOOT_PHASES)){
+    return;                             // already past it
+  }
+  Boot.us[phase] = (now - Boot.last)/Boot.mhz;
+  Boot.last = now;
+  Boot.phase = phase + 1;
+}
+
+void Boot_Clock(uint32_t mhz){
+  Boot.mhz = mhz;
+}
+
+uint32_t Boot_Total(void){
+  uint32_t i, total = 0;
+  for(i = 0; i < BOOT_PHASES; i++){
+    total += Boot.us[i];
+  }
+  return total;
+}
@@ -0,0 +1,76 @@
+// Boot.h
+// Runs on MSP432
+// Boot-phase timestamps.  Reset_Handler starts the DWT cycle
+// counter before SystemInit, and each phase up to the first FSM
+// motor command is marked as it ends.  The record lives in
+// uninitialized RAM, so the C runtime does not clear it, and it
+// survives a watchdog or soft reset: a reset that finds the
+// robot was moving counts a restart and sets warm, so main can
+// get the wheels turning again before the rest of the init.
+// Build option FAST_BOOT: SystemInit runs MCLK from the 48 MHz
+// DCO, main skips the wait for the crystal, and the background
+// task switches to the crystal once the robot is running.
+
+#ifndef BOOT_H_
+#define BOOT_H_
+#include <stdint.h>
+#include "Robot.h"
+
+// phase ending at each mark
+#define BOOT_SYSTEM 0             // reset to the end of SystemInit
+#define BOOT_CINIT 1              // C runtime init, to main
+#define BOOT_CLOCK 2              // Clock_Init48MHz, the crystal
+#define BOOT_MOTOR 3              // Motor_Init and the first command
+#define BOOT_INIT 4               // the other inits, to OS_Launch
+#define BOOT_MOTION 5             // launch to the first FSM command
+#define BOOT_PHASES 6
+
+// MCLK after SystemInit, MHz
+#ifdef FAST_BOOT
+#define BOOT_SYSTEM_MHZ 48
+#else
+#define BOOT_SYSTEM_MHZ 3
+#endif
+
+// duty both wheels get right after a warm restart,
+// until the FSM takes over (0 to 14,999)
+#define BOOT_CRAWL 3000
+
+typedef struct {
+  uint32_t magic;                 // BOOT_MAGIC once the record is valid
+  uint32_t restarts;              // resets since power-on
+  uint32_t moving;                // 1 while the FSM drives the motors
+  uint32_t warm;                  // the reset came while moving
+  uint32_t phase;                 // next phase to mark
+  uint32_t mhz;                   // MCLK during the current phase
+  uint32_t last;                  // cycle count at the last mark
+  uint32_t us[BOOT_PHASES];       // time in each phase
+} Boot_t;
+
+extern ROBOT_LOCAL Boot_t Boot;   // read by main and telemetry
+
+// ------------Boot_Start------------
+// Start the cycle counter from 0 at 3 MHz and open the record,
+// a valid record from before the reset counts a restart
+// Input: none
+// Output: none
+// Assumes: called first in Reset_Handler, before the C runtime
+void Boot_Start(void);
+
+// ------------Boot_Mark------------
+// End a phase now, phases marked out of order are ignored
+// Input: BOOT_SYSTEM to BOOT_MOTION
+// Output: none
+void Boot_Mark(uint32_t phase);
+
+// ------------Boot_Clock------------
+// MCLK has changed, counts from here on are at this rate
+// Input: MHz
+// Output: none
+void Boot_Clock(uint32_t mhz);
+
+// ------------Boot_Total------------
+// Output: us from reset to the last mark
+uint32_t Boot_Total(void);
+
+#endif
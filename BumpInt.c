@@ -48,6 +48,7 @@ policies, either expressed or implied, of the FreeBSD Project.
 
 #include <stdint.h>
 #include "msp.h"
+#include "RamFunc.h"
 
 // Initialize Bump sensors
 // Make six Port 4 pins inputs
@@ -85,7 +86,7 @@ void BumpInt_Init(void){
 // bit 2 Bump2
 // bit 1 Bump1
 // bit 0 Bump0
-uint8_t Bump_Read(void){
+RAMFUNC uint8_t Bump_Read(void){
     uint8_t res;
 
     // toggle, negative logic to positive logic
@@ -0,0 +1,65 @@
+// Deadline.c
+// Runs on MSP432
+// Fail-safe deadline on the control loop.
+// TimerA2 counts up from the last check-in at 187.5 kHz and
+// interrupts when it reaches DEADLINE_MS.  A check-in reads the
+// count, which is the time since the previous check-in, and
+// clears it.
+
+#include <stdint.h>
+#include "msp.h"
+#include "Deadline.h"
+#include "Actuate.h"
+#include "Motor.h"
+
+#define TIMER_CLOCK 187500        // SMCLK 12 MHz divided by 8 and 8
+#define DEADLINE_COUNTS (TIMER_CLOCK*DEADLINE_MS/1000)
+
+Deadline_t Deadline;
+static volatile uint32_t Stage;
+
+void Deadline_Init(void){
+  Deadline.tripped = 0;
+  Deadline.stage = DEADLINE_WAIT;
+  Deadline.checkins = 0;
+  Deadline.nearMisses = 0;
+  Deadline.minSlack = DEADLINE_MS*1000;
+  Stage = DEADLINE_WAIT;
+  TIMER_A2->CTL &= ~0x0030;           // halt Timer A2
+  TIMER_A2->CCTL[0] = 0x0010;         // compare mode, arm CCIFG
+  TIMER_A2->CCR[0] = DEADLINE_COUNTS - 1;
+  TIMER_A2->EX0 = 7;                  // divide by 8
+  NVIC->IP[12] = 0x00;                // TA2_0 is interrupt 12, priority 0
+  NVIC->ISER[0] = 0x00001000;         // enable interrupt 12 in NVIC
+  TIMER_A2->CTL = 0x02D4;             // SMCLK, divide by 8, clear, up mode
+}
+
+void Deadline_CheckIn(void){
+  uint32_t counts = TIMER_A2->R;
+  uint32_t slack;
+  TIMER_A2->CTL |= 0x0004;            // TACLR, restart the deadline
+  if(Deadline.tripped) return;
+  if(counts > DEADLINE_COUNTS) counts = DEADLINE_COUNTS;
+  slack = (DEADLINE_COUNTS - counts)*16/3;  // us, a count is 16/3 us
+  Deadline.checkins++;
+  if(slack < DEADLINE_NEAR_MS*1000){
+    Deadline.nearMisses++;
+  }
+  if(slack < Deadline.minSlack){
+    Deadline.minSlack = slack;
+  }
+}
+
+void Deadline_Stage(uint32_t stage){
+  Stage = stage;
+}
+
+// Runs only if a check-in is late
+void TA2_0_IRQHandler(void){
+  Actuate_Halt();                     // nothing may undo the brake
+  Motor_Halt();
+  TIMER_A2->CTL &= ~0x0030;           // halt Timer A2, fire once
+  TIMER_A2->CCTL[0] &= ~0x0011;       // acknowledge and disarm
+  Deadline.stage = Stage;
+  Deadline.tripped = 1;
+}
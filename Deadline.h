@@ -0,0 +1,54 @@
+// Deadline.h
+// Runs on MSP432
+// Fail-safe deadline on the control loop.  Each control job
+// checks in.  If DEADLINE_MS passes without a check-in,
+// TimerA2 brakes the motors, stops actuation for good, and
+// records which stage of the control job was running.  Every
+// check-in also measures its slack, the time left before the
+// deadline would have fired, and counts near misses.
+// Uses TimerA2 CCR0 interrupt, priority 0, the highest.
+
+#ifndef DEADLINE_H_
+#define DEADLINE_H_
+#include <stdint.h>
+#include "Robot.h"
+
+#define DEADLINE_MS 15            // longest gap between check-ins
+#define DEADLINE_NEAR_MS 8        // slack below this is a near miss
+
+// stage of the control job, marked by the job as it goes
+#define DEADLINE_WAIT 0           // between jobs, control was starved
+#define DEADLINE_CLASSIFY 1       // get_next_state
+#define DEADLINE_FSM 2            // next state, maze and gap logic
+#define DEADLINE_ACTUATE 3        // computing and posting the output
+
+typedef struct {
+  uint32_t tripped;               // 1 once the deadline has fired
+  uint32_t stage;                 // stage running when it fired
+  uint32_t checkins;              // check-ins since Deadline_Init
+  uint32_t nearMisses;            // check-ins with slack under DEADLINE_NEAR_MS
+  uint32_t minSlack;              // us, smallest slack seen
+} Deadline_t;
+
+extern ROBOT_LOCAL Deadline_t Deadline; // read by telemetry
+
+// ------------Deadline_Init------------
+// Start TimerA2, the first check-in is due DEADLINE_MS from now
+// Input: none
+// Output: none
+// Assumes: Motor_Init() and Actuate_Init() have been called
+void Deadline_Init(void);
+
+// ------------Deadline_CheckIn------------
+// The control job is alive, restart the deadline
+// Input: none
+// Output: none
+void Deadline_CheckIn(void);
+
+// ------------Deadline_Stage------------
+// Mark the stage the control job is entering
+// Input: DEADLINE_WAIT to DEADLINE_ACTUATE
+// Output: none
+void Deadline_Stage(uint32_t stage);
+
+#endif
@@ -0,0 +1,63 @@
+// Flash.c
+// Runs on MSP432
+// FLCTL sector erase and immediate word programming.
+// Sector 31 of bank 1 is write-protected except while it is
+// being erased or programmed.  The controller runs the pulses
+// and the pre and post program verify; status is polled.
+
+#include <stdint.h>
+#include "msp.h"
+#include "Flash.h"
+
+#define FLASH_SECTOR 0x80000000   // sector 31 in BANK1_MAIN_WEPROT
+
+uint32_t Flash_Erase(void){
+  const volatile uint32_t *p = (const volatile uint32_t *)FLASH_CAL_ADDRESS;
+  uint32_t i, status;
+  FLCTL->BANK1_MAIN_WEPROT &= ~FLASH_SECTOR;
+  FLCTL->ERASE_CTLSTAT = 0x00080000;  // CLR_STAT
+  FLCTL->ERASE_SECTADDR = FLASH_CAL_ADDRESS;
+  FLCTL->ERASE_CTLSTAT = 0x00000001;
+// bit  mode
+// 3-2  00    TYPE, main memory
+// 1    0     MODE, one sector
+// 0    1     START
+  do{
+    status = FLCTL->ERASE_CTLSTAT;
+  }while(((status&0x00030000) != 0x00030000) && ((status&0x00040000) == 0)); // complete or ADDR_ERR
+  FLCTL->ERASE_CTLSTAT = 0x00080000;
+  FLCTL->BANK1_MAIN_WEPROT |= FLASH_SECTOR;
+  for(i = 0; i < FLASH_CAL_WORDS; i++){
+    if(p[i] != 0xFFFFFFFF){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+uint32_t Flash_Write(const uint32_t *source, uint32_t count){
+  volatile uint32_t *p = (volatile uint32_t *)FLASH_CAL_ADDRESS;
+  uint32_t i, fail = 0;
+  if(count > FLASH_CAL_WORDS){
+    return 1;
+  }
+  FLCTL->BANK1_MAIN_WEPROT &= ~FLASH_SECTOR;
+  FLCTL->PRG_CTLSTAT = 0x0000000D;
+// bit  mode
+// 3    1     VER_PST, verify after
+// 2    1     VER_PRE, verify before
+// 1    0     MODE, each write programs at once
+// 0    1     ENABLE
+  for(i = 0; i < count; i++){
+    p[i] = source[i];
+    while(FLCTL->PRG_CTLSTAT&0x00030000){}; // STATUS, busy
+  }
+  FLCTL->PRG_CTLSTAT = 0x0000000C;    // back to read mode
+  FLCTL->BANK1_MAIN_WEPROT |= FLASH_SECTOR;
+  for(i = 0; i < count; i++){
+    if(p[i] != source[i]){
+      fail = 1;
+    }
+  }
+  return fail;
+}
@@ -0,0 +1,28 @@
+// Flash.h
+// Runs on MSP432
+// Erase and program the last 4 KB sector of flash bank 1,
+// 0x0003F000, reserved as FLASH_CAL in msp432p401r.cmd for
+// calibration data that outlives a reprogram.  The program image
+// stays in bank 0, which keeps running while bank 1 is busy.
+
+#ifndef FLASH_H_
+#define FLASH_H_
+#include <stdint.h>
+
+#define FLASH_CAL_ADDRESS 0x0003F000
+#define FLASH_CAL_WORDS 1024      // 4 KB
+
+// ------------Flash_Erase------------
+// Erase the calibration sector to all ones
+// Input: none
+// Output: 0 if every word reads back erased, 1 on failure
+uint32_t Flash_Erase(void);
+
+// ------------Flash_Write------------
+// Program words at the start of the calibration sector
+// Input: source words and how many (up to FLASH_CAL_WORDS)
+// Output: 0 if every word reads back, 1 on failure
+// Assumes: Flash_Erase() since the last write
+uint32_t Flash_Write(const uint32_t *source, uint32_t count);
+
+#endif
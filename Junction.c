@@ -0,0 +1,108 @@
+// Junction.c
+// Runs on MSP432
+// Finds junctions in the reflectance stream.
+// Bit 7 is the robot's left.  A mark needs three sensors lit
+// at that edge and the line still under the middle, so a line
+// that just drifts to the edge in a curve is not a branch.
+
+#include <stdint.h>
+#include "Junction.h"
+
+#define MIDDLE 0x18               // the two center sensors
+#define AHEAD 0x3C                // the four center sensors
+
+uint8_t Junction_Marks(uint8_t data){
+  uint8_t m = 0;
+  if(data & MIDDLE){
+    if((data & 0xE0) == 0xE0) m |= JUNCTION_LEFT;
+    if((data & 0x07) == 0x07) m |= JUNCTION_RIGHT;
+  }
+  return m;
+}
+
+void Junction_Init(Junction_t *j){
+  j->marked = 0;
+  j->frames = 0;
+  j->bar = 0;
+  j->marks = 0;
+  j->exits = 0;
+  j->goal = 0;
+  j->start = 0;
+  j->last = 0;
+}
+
+uint32_t Junction_Frame(Junction_t *j, uint8_t data, int32_t distance){
+  uint8_t m = Junction_Marks(data);
+  if(data){
+    j->last = data;
+  }
+  if(data == 0xFF){
+    j->bar++;
+    if(j->bar == JUNCTION_GOAL_FRAMES){
+      j->marked = 0;
+      j->frames = 0;
+      j->marks = 0;
+      j->exits = 0;
+      j->goal = 1;
+      return 1;
+    }
+  }else{
+    j->bar = 0;
+  }
+  if(j->marked == 0){
+    if(m){                        // a branch, confirm before trusting it
+      if(j->frames && (j->marks == 0)){
+        j->frames = 0;            // was counting no-line frames
+      }
+      if(j->marks == 0){
+        j->start = distance;      // the array has reached the branch
+      }
+      j->marks |= m;
+      j->frames++;
+      if(j->frames >= JUNCTION_CONFIRM){
+        j->marked = 1;
+        j->frames = 0;
+      }
+      return 0;
+    }
+    j->marks = 0;
+    if(data == 0x00){             // line ended with no branch
+      if((j->last & MIDDLE) == 0){
+        return 0;                 // it left by the side, the FSM looks for it
+      }
+      if(j->frames == 0){
+        j->start = distance;      // the array has passed the end
+      }
+      j->frames++;
+      if(j->frames == JUNCTION_DEAD_FRAMES){
+        j->exits = JUNCTION_DEAD_END;
+        j->goal = 0;
+        return 1;
+      }
+      return 0;
+    }
+    j->frames = 0;
+    return 0;
+  }
+  if(m){                          // still crossing the branch
+    j->marks |= m;
+    j->frames = 0;
+    return 0;
+  }
+  if(data == 0xFF){
+    return 0;                     // may still turn out to be the goal
+  }
+  j->frames++;
+  if((j->frames < JUNCTION_CONFIRM)||(distance - j->start < JUNCTION_CLEAR_MM)){
+    return 0;                     // the array may still be on the branch
+  }
+  j->exits = j->marks;
+  if(data & AHEAD){
+    j->exits |= JUNCTION_STRAIGHT;
+  }
+  j->goal = 0;
+  j->marked = 0;
+  j->frames = 0;
+  j->marks = 0;
+  return 1;
+}
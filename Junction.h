@@ -0,0 +1,62 @@
+// Junction.h
+// Runs on MSP432
+// Finds junctions in the reflectance stream.  A branch shows
+// as the line running from the center out to the left or right
+// edge of the array.  The marks seen while the array crosses
+// the branch are collected; once they have passed, the array
+// shows whether the line also goes straight on.  A line that
+// ends with no branch is a dead end, and a full bar held for
+// JUNCTION_GOAL_FRAMES is the goal.
+
+#ifndef JUNCTION_H_
+#define JUNCTION_H_
+#include <stdint.h>
+
+// exits of a junction, relative to the robot
+#define JUNCTION_LEFT 0x01
+#define JUNCTION_STRAIGHT 0x02
+#define JUNCTION_RIGHT 0x04
+
+#define JUNCTION_DEAD_END 0
+#define JUNCTION_LEFT_TURN JUNCTION_LEFT
+#define JUNCTION_RIGHT_TURN JUNCTION_RIGHT
+#define JUNCTION_LEFT_BRANCH (JUNCTION_LEFT|JUNCTION_STRAIGHT)
+#define JUNCTION_RIGHT_BRANCH (JUNCTION_RIGHT|JUNCTION_STRAIGHT)
+#define JUNCTION_T (JUNCTION_LEFT|JUNCTION_RIGHT)
+#define JUNCTION_CROSS (JUNCTION_LEFT|JUNCTION_STRAIGHT|JUNCTION_RIGHT)
+
+#define JUNCTION_CONFIRM 2        // frames a mark must be seen, and then gone
+#define JUNCTION_DEAD_FRAMES 3    // frames of no line that make a dead end
+#define JUNCTION_GOAL_FRAMES 12   // frames of full bar, longer than crossing a line
+#define JUNCTION_CLEAR_MM 30      // mm past the first mark before looking straight on,
+                                  // a branch line is about 19 mm wide
+
+typedef struct {
+  uint32_t marked;                // 1 while crossing a confirmed branch
+  uint32_t frames;                // frames the current condition has held
+  uint32_t bar;                   // consecutive full-bar frames
+  uint8_t marks;                  // JUNCTION_LEFT/RIGHT seen at this junction
+  uint8_t exits;                  // exits of the last junction found
+  uint8_t goal;                   // 1 if the last junction found is the goal
+  uint8_t last;                   // last frame that saw the line
+  int32_t start;                  // odometry mm where the array reached the last junction
+} Junction_t;
+
+// Branch marks in one frame
+// Input: data is the 8-bit result from the line sensor
+// Output: JUNCTION_LEFT and/or JUNCTION_RIGHT, 0 for none
+uint8_t Junction_Marks(uint8_t data);
+
+// Forget any junction in progress
+void Junction_Init(Junction_t *j);
+
+// Add one frame from the reflectance array
+// Input: data is the 8-bit result from the line sensor
+//        distance is odometry in mm
+// Output: 1 when a junction has been classified, its exits
+//         and goal flag are in j->exits and j->goal, and where
+//         the array reached it (first mark, or end of the line)
+//         in j->start; 0 otherwise
+uint32_t Junction_Frame(Junction_t *j, uint8_t data, int32_t distance);
+
+#endif
@@ -0,0 +1,79 @@
+// Lap.c
+// Runs on MSP432
+// Finds the start/finish bar and times the laps.
+// The row of the lap in progress is filled as its sectors end,
+// and time[] is written last, so a reader that sees laps go up
+// finds the whole row already in place.
+
+#include <stdint.h>
+#include "Lap.h"
+
+// close the sector in progress of the lap in row r
+// The last sector never closes early, so sector < LAP_SECTORS
+static void Lap_Split(Lap_t *l, uint32_t r, uint32_t time){
+  uint32_t ms = time - l->sectorStart;
+  if(ms > 0xFFFF) ms = 0xFFFF;
+  l->split[r][l->sector] = ms;
+  l->sectors[r] = l->sector + 1;
+  l->sectorStart = time;
+}
+
+void Lap_Init(Lap_t *l){
+  uint32_t i;
+  l->bar = 0;
+  l->barDistance = 0;
+  l->running = 0;
+  l->laps = 0;
+  l->lapStart = 0;
+  l->lapDistance = 0;
+  l->sector = 0;
+  l->sectorStart = 0;
+  l->best = 0;
+  for(i = 0; i < LAP_RESULTS; i++){
+    l->time[i] = 0;
+    l->sectors[i] = 0;
+  }
+}
+
+uint32_t Lap_Frame(Lap_t *l, uint8_t data, uint32_t time, int32_t distance){
+  uint32_t r = l->laps % LAP_RESULTS;   // row of the lap in progress
+  uint32_t s, ms;
+  if(data == 0xFF){
+    if(l->bar == 0){
+      l->barDistance = distance;
+    }
+    l->bar++;
+  }else{
+    l->bar = 0;
+  }
+  if((l->bar > 0) && (distance - l->barDistance >= LAP_BAR_MM)){
+    if(l->running == 0){
+      l->running = 1;
+    }else if(distance - l->lapDistance > LAP_HOLDOFF){
+      Lap_Split(l, r, time);
+      ms = time - l->lapStart;
+      if((l->best == 0) || (ms < l->best)){
+        l->best = ms;
+      }
+      l->time[r] = ms;
+      l->laps++;
+      r = l->laps % LAP_RESULTS;
+    }else{
+      return 0;                   // same bar, still crossing it
+    }
+    l->lapStart = time;
+    l->lapDistance = distance;
+    l->sector = 0;
+    l->sectorStart = time;
+    l->sectors[r] = 0;
+    return 1;
+  }
+  if(l->running){
+    s = (distance - l->lapDistance)/LAP_SECTOR_MM;
+    if((distance > l->lapDistance) && (s > l->sector) && (l->sector < LAP_SECTORS - 1)){
+      Lap_Split(l, r, time);
+      l->sector++;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,49 @@
+// Lap.h
+// Runs on MSP432
+// Finds the start/finish bar and times the laps.
+// The bar is all 8 sensors dark for LAP_BAR_MM of encoder
+// distance, Tach_Distance, which unlike odometry from the duty
+// does not change with the motors or the battery.  A 19 mm line
+// crossed at right angles reads dark for at most 20 mm in the
+// simulator, a 60 mm bar for at least 33: the array is never
+// quite square to either.  The first bar starts the clock, each
+// later one ends a lap.  Every LAP_SECTOR_MM within a lap ends a
+// sector, and the last sector ends at the bar.  The last LAP_RESULTS laps are kept with their sector
+// splits, times are from TIME in ms.
+
+#ifndef LAP_H_
+#define LAP_H_
+#include <stdint.h>
+
+#define LAP_BAR_MM 26             // mm of full bar that mark the lap, between the two
+#define LAP_HOLDOFF 500           // mm after a bar before the next counts
+#define LAP_SECTOR_MM 1000        // sector length
+#define LAP_SECTORS 8             // sectors kept per lap, the last one runs to the bar
+#define LAP_RESULTS 8             // laps kept, the oldest is overwritten
+
+typedef struct {
+  uint32_t bar;                   // consecutive frames with every sensor dark
+  int32_t barDistance;            // mm at the first of them
+  uint32_t running;               // 1 once the first bar has been crossed
+  uint32_t laps;                  // laps completed
+  uint32_t lapStart;              // TIME at the last bar
+  int32_t lapDistance;            // mm at the last bar
+  uint32_t sector;                // sector the robot is in
+  uint32_t sectorStart;           // TIME the sector began
+  uint32_t best;                  // fastest lap in ms, 0 before the first
+  uint32_t time[LAP_RESULTS];     // ms of lap n at time[(n-1)%LAP_RESULTS]
+  uint8_t sectors[LAP_RESULTS];   // sectors timed in that lap
+  uint16_t split[LAP_RESULTS][LAP_SECTORS]; // ms of each sector
+} Lap_t;
+
+// No laps, waiting for the first bar
+void Lap_Init(Lap_t *l);
+
+// Add one frame from the reflectance array
+// Input: data is the 8-bit result from the line sensor
+//        time is TIME in ms
+//        distance is Tach_Distance in mm
+// Output: 1 on the frame the bar is confirmed, 0 otherwise
+uint32_t Lap_Frame(Lap_t *l, uint8_t data, uint32_t time, int32_t distance);
+
+#endif
@@ -0,0 +1,74 @@
+// LineEstimator.c
+// Runs on MSP432
+// Fixed-point alpha-beta filter on the line position from the
+// reflectance array.
+//   predict   x' = x + v
+//   residual  r  = z - x'
+//   correct   x  = x' + alpha*r,  v = v + beta*r
+// alpha and beta are Q8.  A residual beyond ESTIMATOR_GATE (a
+// single misread frame jumps that far, the line cannot) only
+// gets a quarter of the gain, so one bad frame moves the
+// estimate a little instead of flipping the steering.
+// Confidence is a Q8 running average that rises on clean frames
+// (one run of adjacent sensors, small residual) and falls on
+// gated, broken or empty frames.
+
+#include <stdint.h>
+#include "LineEstimator.h"
+#include "Robot.h"
+#include "..\inc\Reflectance.h"
+
+void Estimator_Init(LineEstimator_t *e){
+  e->position = 0;
+  e->velocity = 0;
+  e->predicted = 0;
+  e->confidence = 0;
+  e->valid = 0;
+}
+
+void Estimator_Resync(LineEstimator_t *e){
+  e->valid = 0;
+  e->confidence = 0;
+}
+
+// 1 if the set bits of data are one run of adjacent sensors
+static uint32_t Estimator_Clean(uint8_t data){
+  uint8_t low = data&(-data);     // lowest set bit
+  return ((data + low)&data) == 0; // adding it clears a single run
+}
+
+void Estimator_Update(LineEstimator_t *e, uint8_t data){
+  int32_t z, r, gain, target;
+  if(data == 0){                  // no line, coast and lose confidence
+    e->position = e->predicted;
+    target = 0;
+    if(e->confidence < 16){
+      e->valid = 0;               // gone too long, restart on the next sighting
+    }
+  }else{
+    z = Reflectance_Position(data);
+    if(e->valid == 0){            // first sighting, nothing to filter yet
+      e->position = z;
+      e->velocity = 0;
+      e->valid = 1;
+      target = 128;
+    }else{
+      r = z - e->predicted;
+      gain = 256;
+      target = 256;
+      if((r > ESTIMATOR_GATE)||(r < -ESTIMATOR_GATE)){
+        gain = 64;                // suspect frame, quarter gain
+        target = 0;
+      }
+      if(Estimator_Clean(data) == 0){
+        target = target/2;        // broken pattern, glare or a junction
+      }
+      e->position = e->predicted + ((ROBOT_PARAM(ROBOT_ESTIMATOR_ALPHA, ESTIMATOR_ALPHA)*gain/256)*r)/256;
+      e->velocity = e->velocity + ((ROBOT_PARAM(ROBOT_ESTIMATOR_BETA, ESTIMATOR_BETA)*gain/256)*r)/256;
+    }
+  }
+  if(e->position > ESTIMATOR_LIMIT) e->position = ESTIMATOR_LIMIT;
+  if(e->position < -ESTIMATOR_LIMIT) e->position = -ESTIMATOR_LIMIT;
+  e->confidence = e->confidence + (target - e->confidence)/4;
+  e->predicted = e->position + e->velocity;
+}
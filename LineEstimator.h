@@ -0,0 +1,39 @@
+// LineEstimator.h
+// Runs on MSP432
+// Fixed-point alpha-beta filter on the line position from the
+// reflectance array.  Each frame gives a filtered position, the
+// lateral velocity of the line under the array, a confidence,
+// and the position predicted one frame ahead.
+
+#ifndef LINEESTIMATOR_H_
+#define LINEESTIMATOR_H_
+#include <stdint.h>
+
+#define ESTIMATOR_ALPHA 128       // Q8 position gain, 0.5
+#define ESTIMATOR_BETA 26         // Q8 velocity gain, 0.1
+#define ESTIMATOR_GATE 15000      // um, residuals beyond this are suspect
+#define ESTIMATOR_LIMIT 40000     // um, just past the outer sensors
+#define ESTIMATOR_CONFIDENT 160   // Q8 confidence needed to steer on the estimate
+
+typedef struct {
+  int32_t position;               // um, filtered, positive is line to the right
+  int32_t velocity;               // um per frame
+  int32_t predicted;              // um, position expected on the next frame
+  int32_t confidence;             // Q8, 0 (none) to 256 (full)
+  uint32_t valid;                 // 1 once a frame with the line has been seen
+} LineEstimator_t;
+
+// Forget the line, zero confidence
+void Estimator_Init(LineEstimator_t *e);
+
+// Run one filter step
+// Input: data is the 8-bit result from the line sensor
+// Frames with no line coast on the velocity and lose confidence.
+void Estimator_Update(LineEstimator_t *e, uint8_t data);
+
+// Drop the estimate so the next frame with the line seeds it
+// directly at the measured offset.  Used across a gap in the
+// line, where the coasted velocity is stale by the far side.
+void Estimator_Resync(LineEstimator_t *e);
+
+#endif
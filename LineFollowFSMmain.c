@@ -39,11 +39,30 @@ policies, either expressed or implied, of the FreeBSD Project.
 
 #include "msp.h"
 #include "BumpInt.h"
-#include "../inc/Motor.h"
+#include "LineHistory.h"
+#include "SpeedGovernor.h"
+#include "LineEstimator.h"
+#include "Odometry.h"
+#include "Track.h"
+#include "Junction.h"
+#include "Maze.h"
+#include "Lap.h"
+#include "ReflectFilter.h"
+#include "Motor.h"
+#include "Actuate.h"
+#include "Trace.h"
+#include "OS.h"
+#include "Deadline.h"
+#include "RamFunc.h"
+#include "Boot.h"
+#include "Battery.h"
+#include "Tachometer.h"
+#include "MotorCal.h"
+#include "Robot.h"
 #include "../inc/Clock.h"
 #include "..\inc\Reflectance.h"
-#include "..\inc\SysTickInts.h"
 #include "..\inc\CortexM.h"
+#include "..\inc\UART0.h"
 
 
 /*(Left,Right) Motors, call LaunchPad_Output (positive logic)
@@ -58,14 +77,22 @@ policies, either expressed or implied, of the FreeBSD Project.
 0   0,0     neither button      means lost
  */
 
-uint32_t TIME;
-uint8_t reflectance_start;
+ROBOT_LOCAL uint32_t TIME;
+ROBOT_LOCAL uint8_t reflectance_start;
+
+// Course the robot is built for, override with --define=COURSE=
+#define COURSE_LINE 0       // closed loop, learn the lap and race it
+#define COURSE_MAZE 1       // grid maze, explore then run the shortest path
+#ifndef COURSE
+#define COURSE COURSE_LINE
+#endif
 
 // Linked data structure
 struct State {
-  uint8_t out;                // 2-bit output
+  int16_t left;               // left wheel duty, negative is backward
+  int16_t right;              // right wheel duty, negative is backward
   uint8_t delay;              // time to delay in 1ms can only delay up to 255
-  const struct State *next[6]; // Next if 2-bit input is 0-3
+  const struct State *next[8]; // Next for each POS_ input
 };
 
 typedef const struct State State_t;
@@ -74,7 +101,9 @@ typedef const struct State State_t;
 #define POS_SLIGHT_LEFT 2
 #define POS_RIGHT 3
 #define POS_SLIGHT_RIGHT 4
-#define POS_LOST 5
+#define POS_LOST 5          // line ended straight ahead
+#define POS_LOST_LEFT 6     // line left on the robot's right, robot is left of it
+#define POS_LOST_RIGHT 7    // line left on the robot's left, robot is right of it
 
 #define Center &fsm[0]
 #define SlightLeft   &fsm[1]
@@ -93,44 +122,168 @@ typedef const struct State State_t;
 #define OffRight2 &fsm[14]
 #define OffRight3 &fsm[15]
 #define Stop  &fsm[16]
-#define InitCenter &fsm[18]
-
-State_t fsm[18]={
-                //center, left, slightlight, right, slightright, lost
-  //real output of center is 0x03(drive forward), 0x00 for testing
-  {0x03, 50, { Center, Left,  SlightLeft, Right, SlightRight, BufferCenter}},  // Center
-  {0x0B, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffLeft}},  // SlightLeft
-  {0x02, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffLeft}},   // Left
-  {0x0B, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffRight}},   // SlightRight
-  {0x01, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffRight}},   // Right
-  {0x13, 50, { Center, Left,  SlightLeft, Right, SlightRight, BufferCenter2}},  // BufferCenter
-  {0x13, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffCenter}},  // BufferCenter2
-  {0x12, 200, { Center, Left,  SlightLeft, Right, SlightRight, LostRight2}},  // LostRight, last ditch effort to find line
-  {0x12, 200, { Center, Left,  SlightLeft, Right, SlightRight, Stop}},  // LostRight2, last ditch effort to find line
-  {0x13, 50, { Center, Left,  SlightLeft, Right, SlightRight, LostRight}},   // OffCenter
-  {0x0A, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffLeft2}}, // OffLeft
-  {0x0A, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffLeft3}}, // OffLeft2
-  {0x0A, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffCenter}}, // OffLeft3
-  {0x09, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffRight2}},   // OffRight
-  {0x09, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffRight3}},   // OffRight2
-  {0x09, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffCenter}},   // OffRight3
-  {0x00, 250, { Stop, Stop,  Stop, Stop, Stop, Stop}},   // Stop
-  {0x1B, 255, { Center, Left,  SlightLeft, Right, SlightRight, BufferCenter}},  // initCenter
+#define InitCenter &fsm[17]
+#define Brake &fsm[18]
+#define Reverse &fsm[19]
+#define LostRight3 &fsm[20]
+#define LostRight4 &fsm[21]
+#define LostRight5 &fsm[22]
+#define LostRight6 &fsm[23]
+#define LostLeft &fsm[24]
+#define LostLeft2 &fsm[25]
+#define LostLeft3 &fsm[26]
+#define LostLeft4 &fsm[27]
+#define LostLeft5 &fsm[28]
+#define LostLeft6 &fsm[29]
+#define MazeCreepLeft &fsm[30]
+#define MazeCreepRight &fsm[31]
+#define MazeLeft &fsm[32]
+#define MazeLeft2 &fsm[33]
+#define MazeRight &fsm[34]
+#define MazeRight2 &fsm[35]
+#define MazeBack &fsm[36]
+#define GapHold &fsm[37]
 
+// Output is a signed duty for each wheel (0 to 14,999 of
+// MOTOR_DUTY_FULL), negative runs that wheel backward.  It is
+// sent as a speed, ODOMETRY_FULL_SPEED at MOTOR_DUTY_FULL, so
+// with a MotorCal table both wheels run matched.
+// (+,+) forward, (+,-) pivot right, (-,+) pivot left,
+// (-,-) backward, (0,0) brake.  Stop puts the drivers to sleep.
+// When the line is lost, the side it left from (LineHistory)
+// picks OffLeft or OffRight, which pivot toward it.  If that
+// fails, LostRight/LostLeft sweep toward that side first and
+// then widen: 100 ms one way, 200 back, 300 the first way,
+// 400 back, then give up.
+// The Maze states turn at a junction: creep until the wheels are
+// over it, MAZE_AXLE_MM past where the array reached it,
+// pivot until the old line has left the array, then keep
+// pivoting until the new line is under the middle.
+// A line lost straight ahead from Center or a slight state is
+// a gap in a dashed line: GapHold drives on for GAP_MM, bent a
+// little toward where the line was headed, then falls back to
+// BufferCenter.  A line lost off one side is searched for on
+// that side at once.
+RAMDATA State_t fsm[38]={
+                //center, left, slightlight, right, slightright, lost, lostleft, lostright
+  {6700, 6700, 50, { Center, Left,  SlightLeft, Right, SlightRight, GapHold, OffLeft, OffRight}},  // Center
+  {6000, 5000, 50, { Center, Left,  SlightLeft, Right, SlightRight, GapHold, OffLeft, OffRight}},  // SlightLeft, ease right
+  {3500, -3500, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffLeft, OffLeft, OffRight}},   // Left
+  {5000, 6000, 50, { Center, Left,  SlightLeft, Right, SlightRight, GapHold, OffLeft, OffRight}},   // SlightRight, ease left
+  {-3500, 3500, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffRight, OffLeft, OffRight}},   // Right
+  {4250, 4250, 50, { Center, Left,  SlightLeft, Right, SlightRight, BufferCenter2, OffLeft, OffRight}},  // BufferCenter
+  {4250, 4250, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffCenter, OffLeft, OffRight}},  // BufferCenter2
+  {3500, -3500, 100, { Center, Left,  SlightLeft, Right, SlightRight, LostRight2, LostRight2, LostRight2}},  // LostRight, sweep right first
+  {-3500, 3500, 200, { Center, Left,  SlightLeft, Right, SlightRight, LostRight3, LostRight3, LostRight3}},  // LostRight2
+  {4250, 4250, 50, { Center, Left,  SlightLeft, Right, SlightRight, Reverse, OffLeft, OffRight}},   // OffCenter
+  {4900, -4900, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffLeft2, OffLeft2, OffLeft2}}, // OffLeft
+  {4900, -4900, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffLeft3, OffLeft3, OffLeft3}}, // OffLeft2
+  {4900, -4900, 50, { Center, Left,  SlightLeft, Right, SlightRight, LostRight, LostRight, LostRight}}, // OffLeft3
+  {-4900, 4900, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffRight2, OffRight2, OffRight2}},   // OffRight
+  {-4900, 4900, 50, { Center, Left,  SlightLeft, Right, SlightRight, OffRight3, OffRight3, OffRight3}},   // OffRight2
+  {-4900, 4900, 50, { Center, Left,  SlightLeft, Right, SlightRight, LostLeft, LostLeft, LostLeft}},   // OffRight3
+  {0, 0, 250, { Stop, Stop,  Stop, Stop, Stop, Stop, Stop, Stop}},   // Stop
+  {14000, 14000, 255, { Center, Left,  SlightLeft, Right, SlightRight, BufferCenter, OffLeft, OffRight}},  // initCenter
+  {0, 0, 100, { Stop, Stop,  Stop, Stop, Stop, Stop, Stop, Stop}},   // Brake, stop fast then sleep
+  {-4250, -4250, 150, { Center, Left,  SlightLeft, Right, SlightRight, LostRight, LostRight, LostLeft}},   // Reverse, back over an overshot corner
+  {3500, -3500, 200, { Center, Left,  SlightLeft, Right, SlightRight, LostRight4, LostRight4, LostRight4}},  // LostRight3
+  {3500, -3500, 100, { Center, Left,  SlightLeft, Right, SlightRight, LostRight5, LostRight5, LostRight5}},  // LostRight4
+  {-3500, 3500, 200, { Center, Left,  SlightLeft, Right, SlightRight, LostRight6, LostRight6, LostRight6}},  // LostRight5
+  {-3500, 3500, 200, { Center, Left,  SlightLeft, Right, SlightRight, Brake, Brake, Brake}},  // LostRight6, give up
+  {-3500, 3500, 100, { Center, Left,  SlightLeft, Right, SlightRight, LostLeft2, LostLeft2, LostLeft2}},  // LostLeft, sweep left first
+  {3500, -3500, 200, { Center, Left,  SlightLeft, Right, SlightRight, LostLeft3, LostLeft3, LostLeft3}},  // LostLeft2
+  {-3500, 3500, 200, { Center, Left,  SlightLeft, Right, SlightRight, LostLeft4, LostLeft4, LostLeft4}},  // LostLeft3
+  {-3500, 3500, 100, { Center, Left,  SlightLeft, Right, SlightRight, LostLeft5, LostLeft5, LostLeft5}},  // LostLeft4
+  {3500, -3500, 200, { Center, Left,  SlightLeft, Right, SlightRight, LostLeft6, LostLeft6, LostLeft6}},  // LostLeft5
+  {3500, -3500, 200, { Center, Left,  SlightLeft, Right, SlightRight, Brake, Brake, Brake}},  // LostLeft6, give up
+  {4250, 4250, 10, { MazeCreepLeft, MazeCreepLeft,  MazeCreepLeft, MazeCreepLeft, MazeCreepLeft, MazeCreepLeft, MazeCreepLeft, MazeCreepLeft}},  // MazeCreepLeft, sensor to axle, then MazeLeft or MazeBack
+  {4250, 4250, 10, { MazeCreepRight, MazeCreepRight,  MazeCreepRight, MazeCreepRight, MazeCreepRight, MazeCreepRight, MazeCreepRight, MazeCreepRight}},  // MazeCreepRight
+  {-3500, 3500, 20, { MazeLeft, MazeLeft,  MazeLeft, MazeLeft, MazeLeft, MazeLeft2, MazeLeft2, MazeLeft2}},  // MazeLeft, until the old line is gone
+  {-3500, 3500, 20, { Center, MazeLeft2,  SlightLeft, MazeLeft2, SlightRight, MazeLeft2, MazeLeft2, MazeLeft2}},  // MazeLeft2, until centered
+  {3500, -3500, 20, { MazeRight, MazeRight,  MazeRight, MazeRight, MazeRight, MazeRight2, MazeRight2, MazeRight2}},  // MazeRight, until the old line is gone
+  {3500, -3500, 20, { Center, MazeRight2,  SlightLeft, MazeRight2, SlightRight, MazeRight2, MazeRight2, MazeRight2}},  // MazeRight2, until centered
+  {-3500, 3500, 250, { MazeLeft2, MazeLeft2,  MazeLeft2, MazeLeft2, MazeLeft2, MazeLeft2, MazeLeft2, MazeLeft2}},  // MazeBack, turn around at a dead end
+  {6700, 6700, 10, { Center, Left,  SlightLeft, Right, SlightRight, GapHold, OffLeft, OffRight}},  // GapHold, steer added in main
 };
 
-State_t *Spt;  // pointer to the current state
-volatile uint8_t bump_sensor_in;
-volatile uint8_t reflect_in;
-uint8_t fsm_in;
+ROBOT_LOCAL State_t *Spt;  // pointer to the current state
+ROBOT_LOCAL volatile uint8_t bump_sensor_in;
+ROBOT_LOCAL volatile uint8_t reflect_in;  // after the glitch filter
+ROBOT_LOCAL ReflectFilter_t Filter;       // majority vote over the last few frames
+ROBOT_LOCAL uint8_t fsm_in;
+ROBOT_LOCAL LineHistory_t History;  // recent line positions, updated every frame
+ROBOT_LOCAL SpeedGovernor_t Governor; // straightaway boost, updated every frame
+ROBOT_LOCAL LineEstimator_t Estimator; // filtered line position, updated every frame
+ROBOT_LOCAL Odometry_t Odometry;       // distance from the commanded duties, every 1ms
+ROBOT_LOCAL Track_t Track;             // learned lap and speed profile, updated every frame
+ROBOT_LOCAL Junction_t Junctions;      // junction in progress, maze course only
+ROBOT_LOCAL Maze_t Maze;               // map of the maze and the shortest path
+ROBOT_LOCAL volatile uint8_t junction_ready; // set by SysTick, Junctions has a result
+ROBOT_LOCAL uint8_t maze_watch;        // look for junctions, off while turning
+ROBOT_LOCAL int32_t creep_end;         // odometry mm with the axle over the junction
+ROBOT_LOCAL State_t *creep_turn;       // turn to make there
+
+// Travel from where the array reached a junction, its first
+// branch mark or the end of the line, until the axle is over
+// it: the array is about 70 mm ahead of the axle, plus half the
+// width of the line.
+#define MAZE_AXLE_MM 80
+
+// Longest gap in a dashed line to drive across, override with --define=GAP_MM=
+#ifndef GAP_MM
+#define GAP_MM 150
+#endif
+// Steer added across a gap, duty per mm the line was headed
+// off center when it left
+#define GAP_STEER 80
+ROBOT_LOCAL int32_t gap_start;         // odometry mm where the line went away
+ROBOT_LOCAL int32_t gap_offset;        // um, where the line was headed then
+ROBOT_LOCAL int16_t gap_left, gap_right; // duties held across the gap
+ROBOT_LOCAL Lap_t Laps;                // lap counter and split times, updated every frame
+ROBOT_LOCAL uint32_t lap_reported;     // laps sent over UART0
+
+// Control task period in ms.  State dwells are counted in these,
+// rounded down, at least one.
+#define CONTROL_MS 5
+ROBOT_LOCAL uint32_t dwell;            // control periods left in the current state
+ROBOT_LOCAL int16_t cmd_left, cmd_right; // duties last posted
+ROBOT_LOCAL uint32_t sense_id, control_id; // OS task ids
+
+// Laps to run before stopping, 0 runs on, override with --define=LAP_STOP=
+#ifndef LAP_STOP
+#define LAP_STOP 0
+#endif
 
-void SysTick_Handler(void){ // every 1ms
+// Thresholds on the predicted position, um
+#define SLIGHT_BAND 3000     // inside this is centered
+#define STRONG_BAND 17500    // past this is a full turn
+
+// Sensing task, every 1 ms
+// A frame takes two runs: one charges the sensors, the next
+// reads them 1 ms later, then every per-frame filter runs.
+RAMFUNC void sense(void){
   // write this as part of Lab 10
+    TRACE_ENTER(TRACE_SENSE);
     TIME = TIME + 1;
+    Odometry_Tick(&Odometry);
+    if(Battery_Tick()){
+        Motor_Supply(Battery_Millivolts());
+    }
 
     if(reflectance_start){
-        reflect_in = Reflectance_End();
+        reflect_in = Filter_Majority(&Filter, Reflectance_End());
         reflectance_start = 0;
+        LineHistory_Add(&History, reflect_in);
+        Governor_Add(&Governor, reflect_in, ROBOT_TUNE(0, ROBOT_LEFT, fsm[0].left));
+        Estimator_Update(&Estimator, reflect_in);
+        if(COURSE == COURSE_MAZE){
+            if(maze_watch && (junction_ready == 0) && Junction_Frame(&Junctions, reflect_in, Odometry_Distance(&Odometry))){
+                junction_ready = 1;
+            }
+        }else{
+            uint32_t mark = Lap_Frame(&Laps, reflect_in, TIME, (int32_t)Tach_Distance());
+            Track_Frame(&Track, reflect_in, &Odometry, mark);
+        }
     }
     else{
         if(TIME % 9 == 0){
@@ -138,14 +291,17 @@ void SysTick_Handler(void){ // every 1ms
             reflectance_start = 1;
         }
     }
+    TRACE_EXIT(TRACE_SENSE);
 }
 
 // we do not care about critical section/race conditions
 // triggered on touch, falling edge
-void PORT4_IRQHandler(void){
+RAMFUNC void PORT4_IRQHandler(void){
     // port 4, pins 7,6,5,3,2,0
+    TRACE_ENTER(TRACE_PORT4);
     P4->IFG &= ~0xEC;       // acknowledgment, clear flag
     bump_sensor_in = Bump_Read();
+    TRACE_EXIT(TRACE_PORT4);
 }
 
 
@@ -155,51 +311,438 @@ void PORT4_IRQHandler(void){
 3) Input (LaunchPad buttons)
 4) Next depends on (Input,State)
  */
-void get_next_state(void){
+RAMFUNC void get_next_state(void){
+    uint8_t data = reflect_in;  // one frame throughout, SysTick may replace it
+    TRACE_STAMP(TRACE_CLASSIFY);
 
-    if(reflect_in == 0x18 ||reflect_in == 0xFF || reflect_in == 0x3C || reflect_in == 0x7E){
+    // steer on where the filter expects the line next frame,
+    // raw patterns below are the fallback while it is unsure
+    if((data != 0x00) && (Estimator.confidence >= ESTIMATOR_CONFIDENT)){
+        int32_t predicted = Estimator.predicted;
+        if(predicted > ROBOT_PARAM(ROBOT_STRONG_BAND, STRONG_BAND)){
+            fsm_in = POS_LEFT;          // line far right, robot is left of it
+        }
+        else if(predicted > ROBOT_PARAM(ROBOT_SLIGHT_BAND, SLIGHT_BAND)){
+            fsm_in = POS_SLIGHT_LEFT;
+        }
+        else if(predicted < -ROBOT_PARAM(ROBOT_STRONG_BAND, STRONG_BAND)){
+            fsm_in = POS_RIGHT;
+        }
+        else if(predicted < -ROBOT_PARAM(ROBOT_SLIGHT_BAND, SLIGHT_BAND)){
+            fsm_in = POS_SLIGHT_RIGHT;
+        }
+        else{
+            fsm_in = POS_CENTER;
+        }
+        return;
+    }
+    if(data == 0x18 ||data == 0xFF || data == 0x3C || data == 0x7E){
         fsm_in = POS_CENTER;
     }
-    else if((reflect_in >= 0x08 && reflect_in < 0x0D)){
+    else if((data >= 0x08 && data < 0x0D)){
         fsm_in = POS_SLIGHT_LEFT;
         //0110 0000
     }
-    else if((reflect_in >= 0x01 && reflect_in <= 0x07) || (reflect_in >= 0x0D && reflect_in <= 0x0F)){
+    else if((data >= 0x01 && data <= 0x07) || (data >= 0x0D && data <= 0x0F)){
         fsm_in = POS_LEFT;
     }
-    else if(reflect_in >= 0x10 && reflect_in < 0x80){
+    else if(data >= 0x10 && data < 0x80){
         fsm_in = POS_SLIGHT_RIGHT;
     }
-    else if (reflect_in >= 0x80 && reflect_in <= 0xF0){
+    else if (data >= 0x80 && data <= 0xF0){
         fsm_in = POS_RIGHT;
     }
-    else if (reflect_in == 0x00){
-        fsm_in = POS_LOST;
+    else if (data == 0x00){
+        int32_t side = LineHistory_ExitSide(&History);
+        if(side > 0){
+            fsm_in = POS_LOST_LEFT;     // line went off to the right
+        }
+        else if(side < 0){
+            fsm_in = POS_LOST_RIGHT;    // line went off to the left
+        }
+        else{
+            fsm_in = POS_LOST;
+        }
     }
     else{
         // default
         fsm_in = POS_CENTER;
     }
 }
-int main(void){
-  Clock_Init48MHz();
-  Motor_Init();
-  BumpInt_Init();
-  Reflectance_Init();
-  bump_sensor_in = 0;
-  SysTick_Init(48000,2);  // set up SysTick for 1000 Hz interrupts
-  EnableInterrupts();
-  Spt = Center;
+// 1 while the FSM is following a line, 0 while it is turning
+// at a junction, stopping, or stopped
+uint32_t following(State_t *s){
+    return ((s < MazeCreepLeft) || (s == GapHold)) && (s != Stop) && (s != Brake);
+}
+
+// Maze course: act on a junction found by SysTick
+// Input: next state chosen by the FSM
+// Output: state to go to
+State_t *maze_step(State_t *next){
+    uint32_t action;
+    if(maze_watch != following(next)){
+        Junction_Init(&Junctions);  // start clean after a turn
+        junction_ready = 0;
+        maze_watch = following(next);
+    }
+    if(junction_ready == 0){
+        if(maze_watch && Junctions.marked){
+            return Center;          // straight across a branch, do not chase it
+        }
+        return next;
+    }
+    junction_ready = 0;
+    creep_end = Junctions.start + MAZE_AXLE_MM;
+    action = Maze_Node(&Maze, Junctions.exits, Junctions.goal, creep_end);
+    if(action == MAZE_STOP){
+        maze_watch = 0;
+        return Brake;
+    }
+    if(action == MAZE_STRAIGHT){
+        return next;
+    }
+    maze_watch = 0;
+    if(action == MAZE_RIGHT){
+        creep_turn = MazeRight;
+        return MazeCreepRight;
+    }
+    creep_turn = (action == MAZE_LEFT) ? MazeLeft : MazeBack;
+    return MazeCreepLeft;
+}
+
+// Send lap n over UART0, one line:
+// lap n ms best ms: sector ms ...
+// About 5 ms at 115200 bps, once a lap.
+void lap_report(uint32_t n){
+    uint32_t r = (n - 1)%LAP_RESULTS, s;
+    UART0_OutString("lap ");
+    UART0_OutUDec(n);
+    UART0_OutChar(' ');
+    UART0_OutUDec(Laps.time[r]);
+    UART0_OutString(" best ");
+    UART0_OutUDec(Laps.best);
+    UART0_OutChar(':');
+    for(s = 0; s < Laps.sectors[r]; s++){
+        UART0_OutChar(' ');
+        UART0_OutUDec(Laps.split[r][s]);
+    }
+    UART0_OutString("\r\n");
+}
+
+// Send the pack over UART0: battery mV state
+// (0 ok, 1 low and capped, 2 cut off)
+void battery_report(void){
+    UART0_OutString("battery ");
+    UART0_OutUDec(Battery_Millivolts());
+    UART0_OutChar(' ');
+    UART0_OutUDec(Battery_State());
+    UART0_OutString("\r\n");
+}
+
+// Send the deadline misses of each task over UART0
+void misses_report(void){
+    UART0_OutString("misses sense ");
+    UART0_OutUDec(OS_Misses(sense_id));
+    UART0_OutString(" control ");
+    UART0_OutUDec(OS_Misses(control_id));
+    UART0_OutString("\r\n");
+}
 
-  while(1){
-    Read_Command(Spt->out);            // set output from FSM
-    Clock_Delay1ms(Spt->delay);   // wait
+// Send the control deadline over UART0:
+// deadline tripped stage: check-ins near-misses min-slack-us
+void deadline_report(void){
+    UART0_OutString("deadline ");
+    UART0_OutUDec(Deadline.tripped);
+    UART0_OutChar(' ');
+    UART0_OutUDec(Deadline.stage);
+    UART0_OutChar(':');
+    UART0_OutChar(' ');
+    UART0_OutUDec(Deadline.checkins);
+    UART0_OutChar(' ');
+    UART0_OutUDec(Deadline.nearMisses);
+    UART0_OutChar(' ');
+    UART0_OutUDec(Deadline.minSlack);
+    UART0_OutString("\r\n");
+}
+
+#ifdef LATENCY_TRACE
+// Send the latency histograms over UART0, one line per interval:
+// name worst us: count per bin (<1us, 1us, 2-3us, 4-7us, ...)
+void trace_report(void){
+    static char * const name[TRACE_INTERVALS] = {"capture", "wait", "decide", "actuate", "total"};
+    const uint32_t *h;
+    uint32_t i, b;
+    for(i = 0; i < TRACE_INTERVALS; i++){
+        h = Trace_Histogram(i);
+        UART0_OutString(name[i]);
+        UART0_OutChar(' ');
+        UART0_OutUDec(Trace_Worst(i));
+        UART0_OutChar(':');
+        for(b = 0; b < TRACE_BINS; b++){
+            UART0_OutChar(' ');
+            UART0_OutUDec(h[b]);
+        }
+        UART0_OutString("\r\n");
+    }
+}
+
+// Send the cycles each handler takes over UART0, one line per
+// handler: name average longest.  Compare a RUN_FROM_RAM build
+// with a flash build to see what the wait states cost.
+void cycles_report(void){
+    static char * const name[TRACE_HANDLERS] = {"systick", "port4", "ta0", "ta1", "sense", "control"};
+    uint32_t i;
+    for(i = 0; i < TRACE_HANDLERS; i++){
+        UART0_OutString("cycles ");
+        UART0_OutString(name[i]);
+        UART0_OutChar(' ');
+        UART0_OutUDec(Trace_Average(i));
+        UART0_OutChar(' ');
+        UART0_OutUDec(Trace_Longest(i));
+        UART0_OutString("\r\n");
+    }
+}
+#endif
+
+// Post the output of the current state, every control period
+// so the learned profile follows the distance
+RAMFUNC void actuate(void){
+    int16_t left = ROBOT_TUNE(Spt - fsm, ROBOT_LEFT, Spt->left);
+    int16_t right = ROBOT_TUNE(Spt - fsm, ROBOT_RIGHT, Spt->right);
+    int32_t top, limit;
+    // straight, learned lap or boosted while steady; a maze keeps
+    // the base duty so the junctions are found at a known speed
+    if((Spt == Center)&&(COURSE != COURSE_MAZE)){
+      left = Track_Duty(&Track, left, Governor_Duty(&Governor, left), &Odometry);
+      right = Track_Duty(&Track, right, Governor_Duty(&Governor, right), &Odometry);
+    }else if(Spt == GapHold){          // straight on, bent toward the line
+      left = gap_left;
+      right = gap_right;
+    }
+    // no faster than the pack can hold at the nominal voltage,
+    // both wheels scaled alike so a turn keeps its radius
+    limit = Battery_Limit();
+    top = (left < 0) ? -left : left;
+    if(right > top) top = right;
+    if(-right > top) top = -right;
+    if(top > limit){
+      left = (left*limit)/top;
+      right = (right*limit)/top;
+    }
+    if(Spt == Stop){
+      Actuate_Command(0, 0, ACTUATE_STOP);      // idle, drivers asleep
+    }else{
+      Actuate_Command((left*ODOMETRY_FULL_SPEED)/MOTOR_DUTY_FULL,  // output from FSM,
+                      (right*ODOMETRY_FULL_SPEED)/MOTOR_DUTY_FULL, // applied by TimerA1
+                      ACTUATE_SPEED);
+    }
+    Odometry_Duty(&Odometry, left, right);
+    Boot.moving = (Spt != Stop);       // a reset now resumes at BOOT_CRAWL
+    if(Boot.moving){
+      Boot_Mark(BOOT_MOTION);
+    }
+    cmd_left = left;
+    cmd_right = right;
+}
+
+// Control task, every CONTROL_MS
+// Runs the FSM: when the dwell of the current state is over,
+// classify the newest frame and move to the next state.
+RAMFUNC void control(void){
+    State_t *last;
+    TRACE_ENTER(TRACE_CONTROL);
+    Deadline_CheckIn();
+    if(Deadline.tripped){
+      Spt = Stop;                      // motors already braked, report and stay
+    }
+    if(dwell > 1){
+      dwell--;
+      Deadline_Stage(DEADLINE_ACTUATE);
+      actuate();
+      Deadline_Stage(DEADLINE_WAIT);
+      TRACE_EXIT(TRACE_CONTROL);
+      return;
+    }
     // first transform reflectance_input from 64 conditions to ~8 conditions?
+    Deadline_Stage(DEADLINE_CLASSIFY);
     get_next_state();
+    Deadline_Stage(DEADLINE_FSM);
+    last = Spt;
     Spt = Spt->next[fsm_in]; // next depends on input and state
-    if(bump_sensor_in > 0){Spt = Stop;}
+    if(COURSE == COURSE_MAZE){
+      if(((last == MazeLeft2)||(last == MazeRight2))&&Junction_Marks(reflect_in)){
+        Spt = last;                    // the goal pad or a branch, not the new line yet
+      }
+      Spt = maze_step(Spt);
+      if((Spt == Stop)&&(last != Stop)){
+        bump_sensor_in = 0;            // forget the crash, wait for a fresh tap
+      }else if((Spt == Stop)&&(bump_sensor_in > 0)&&(Bump_Read() == 0)){  // tapped at the start, fast run
+        bump_sensor_in = 0;
+        if(Maze_Restart(&Maze, Odometry_Distance(&Odometry))){Spt = Center;}
+      }
+    }
+    if((Spt == MazeCreepLeft)||(Spt == MazeCreepRight)){
+      if(Odometry_Distance(&Odometry) >= creep_end){
+        Spt = creep_turn;              // wheels over the junction, turn
+      }
+    }
+    if(Spt == GapHold){
+      if(last != GapHold){             // line just went away, drive on toward it
+        gap_start = Odometry_Distance(&Odometry);
+        gap_offset = LineHistory_ExitOffset(&History);
+        gap_left = ROBOT_TUNE(Spt - fsm, ROBOT_LEFT, Spt->left) + (gap_offset/1000)*GAP_STEER;
+        gap_right = ROBOT_TUNE(Spt - fsm, ROBOT_RIGHT, Spt->right) - (gap_offset/1000)*GAP_STEER;
+        Estimator_Resync(&Estimator);  // take the far side at its own offset
+      }else if(Odometry_Distance(&Odometry) - gap_start > ROBOT_PARAM(ROBOT_GAP_MM, GAP_MM)){
+        Spt = BufferCenter;            // not a gap, the line is really gone
+      }
+    }
+    if((LAP_STOP > 0)&&(Laps.laps >= LAP_STOP)&&(Spt != Stop)){Spt = Brake;}
+    if((bump_sensor_in > 0)&&(Spt != Stop)){Spt = Brake;}
+    if((Battery_State() == BATTERY_CUTOFF)&&(Spt != Stop)){Spt = Brake;}
+    if(Spt != last){
+      TRACE_STAMP(TRACE_CHANGE);
+    }
+    dwell = ROBOT_TUNE(Spt - fsm, ROBOT_DELAY, Spt->delay)/CONTROL_MS;
+    if(dwell == 0){
+      dwell = 1;
+    }
+    Deadline_Stage(DEADLINE_ACTUATE);
+    actuate();
+    Deadline_Stage(DEADLINE_WAIT);
+    TRACE_EXIT(TRACE_CONTROL);
+}
+
+// Send the boot phases over UART0 once the FSM has driven:
+// boot total-us restarts: us per phase (system, cinit, clock,
+// motor, init, motion)
+void boot_report(void){
+    uint32_t i;
+    UART0_OutString("boot ");
+    UART0_OutUDec(Boot_Total());
+    UART0_OutChar(' ');
+    UART0_OutUDec(Boot.restarts);
+    UART0_OutChar(':');
+    for(i = 0; i < BOOT_PHASES; i++){
+        UART0_OutChar(' ');
+        UART0_OutUDec(Boot.us[i]);
+    }
+    UART0_OutString("\r\n");
+}
 
+// Background task, runs when sensing and control are idle
+// Anything slow goes here, it cannot delay the FSM.
+void telemetry(void){
+    uint32_t stopped = 0;
+    uint32_t booted = 0;
+#ifdef FAST_BOOT
+    Clock_Init48MHz();                 // the crystal settles here, behind the FSM
+#endif
+    while(1){
+      if((booted == 0)&&(Boot.phase == BOOT_PHASES)){
+        booted = 1;
+        boot_report();
+      }
+      if(lap_reported != Laps.laps){
+        lap_reported++;
+        lap_report(lap_reported);
+        battery_report();
+      }
+      if((Spt == Stop)&&(stopped == 0)){
+        stopped = 1;
+        misses_report();
+        battery_report();
+        deadline_report();
+#ifdef LATENCY_TRACE
+        trace_report();
+        cycles_report();
+#endif
+      }else if(Spt != Stop){
+        stopped = 0;
+      }
+      WaitForInterrupt();
+    }
+}
+
+#ifdef CHARACTERIZE
+// Characterization build, instead of the FSM: measure both motors
+// with the robot on a stand, store the curves, and send
+// motorcal result: left speeds, then right speeds, mm/s
+void characterize(void){
+    MotorCal_t cal;
+    uint32_t w, i, result;
+    EnableInterrupts();
+    result = MotorCal_Run(&cal);
+    for(w = 0; w < 2; w++){
+        UART0_OutString("motorcal ");
+        UART0_OutUDec(result);
+        UART0_OutChar(':');
+        for(i = 0; i < MOTORCAL_POINTS; i++){
+            UART0_OutChar(' ');
+            UART0_OutUDec(cal.speed[w][i]);
+        }
+        UART0_OutString("\r\n");
     }
+    while(1){
+        WaitForInterrupt();
+    }
+}
+#endif
+
+int main(void){
+  Boot_Mark(BOOT_CINIT);
+  OS_Init();              // interrupts off until OS_Launch
+  RamFunc_Init();         // vectors to SRAM in a RUN_FROM_RAM build
+#ifndef FAST_BOOT
+  Clock_Init48MHz();      // waits for the crystal
+#endif
+  Boot_Mark(BOOT_CLOCK);
+  Boot_Clock(48);
+  Motor_Init();
+  if(Boot.warm){
+    Motor_ForwardNow(BOOT_CRAWL, BOOT_CRAWL); // reset mid-run, roll now, interrupts are still off
+  }
+  Boot_Mark(BOOT_MOTOR);
+  Actuate_Init();
+#ifdef LATENCY_TRACE
+  Trace_Init();
+#endif
+  BumpInt_Init();
+  Reflectance_Init();
+  Battery_Init();
+  MotorCal_Init();        // uncalibrated, speed is proportional to duty
+  Tach_Init();            // encoder distance, the lap bar is measured on it
+  UART0_Init();
+  bump_sensor_in = 0;
+  Filter_Init(&Filter);
+  LineHistory_Init(&History);
+  Governor_Init(&Governor);
+  Estimator_Init(&Estimator);
+  Odometry_Init(&Odometry);
+  Track_Init(&Track);
+  Lap_Init(&Laps);
+  lap_reported = 0;
+  Junction_Init(&Junctions);
+  Maze_Init(&Maze);
+  junction_ready = 0;
+  maze_watch = 1;
+  TIME = 0;
+  reflectance_start = 0;
+  reflect_in = 0;
+  cmd_left = 0;
+  cmd_right = 0;
+  Spt = Center;
+  dwell = ROBOT_TUNE(Spt - fsm, ROBOT_DELAY, Spt->delay)/CONTROL_MS;
+  sense_id = OS_AddTask(&sense, 1);               // 1 ms, highest priority
+  control_id = OS_AddTask(&control, CONTROL_MS);
+  OS_AddTask(&telemetry, 0);                      // whatever time is left
+#ifdef CHARACTERIZE
+  characterize();
+#endif
+  Boot_Mark(BOOT_INIT);
+  Deadline_Init();                                // first check-in due in DEADLINE_MS
+  OS_Launch(48000);                               // 1 ms ticks at 48 MHz
+  return 0;
  }
 
 
@@ -0,0 +1,114 @@
+// LineHistory.c
+// Runs on MSP432
+// Short history of line positions seen by the reflectance
+// array, used to remember which side the line left from so
+// the lost-line search can turn toward it.
+// Position is from Reflectance_Position, in um, positive
+// when the line is under the robot's right sensors.
+
+#include <stdint.h>
+#include "LineHistory.h"
+#include "..\inc\Reflectance.h"
+
+void LineHistory_Init(LineHistory_t *h){
+  h->newest = 0;
+  h->count = 0;
+  h->lost = 0;
+  h->slope = 0;
+  h->predicted = 0;
+  h->jumped = 0;
+}
+
+// Sensors in a run
+static int32_t LineHistory_Width(uint8_t run){
+  int32_t n = 0;
+  while(run){
+    run = run&(run - 1);
+    n++;
+  }
+  return n;
+}
+
+// Position of the line in a frame, which may also show part of a
+// bar or a crossing line.  Of two runs of sensors the line is the
+// one no wider than the tape; if both or neither are, the one
+// nearer the last position.  A lone run too far from the last
+// position is what is left of the bar after the line has gone,
+// the line cannot jump across the array in one frame.
+// Output: 1 with *position set, 0 if the frame has no one line
+static uint32_t LineHistory_Line(LineHistory_t *h, uint8_t data, int32_t *position){
+  uint8_t low = data&(-data);
+  uint8_t rest = (data + low)&data;   // data without its lowest run
+  int32_t a, b, n, m, last;
+  if(rest == 0){                      // one run
+    *position = Reflectance_Position(data);
+    if((h->count > 0) && (h->jumped < HISTORY_SIZE) &&
+       ((*position - h->position[h->newest] > HISTORY_JUMP) ||
+        (h->position[h->newest] - *position > HISTORY_JUMP))){
+      h->jumped = h->jumped + 1;
+      return 0;                       // the rest of a bar leaving the array
+    }
+    h->jumped = 0;
+    return 1;
+  }
+  if((((rest + (rest&(-rest)))&rest) != 0) || (h->count == 0)){
+    return 0;                         // three runs, or nothing to compare with
+  }
+  n = (LineHistory_Width(data^rest) > HISTORY_TAPE);
+  m = (LineHistory_Width(rest) > HISTORY_TAPE);
+  last = h->position[h->newest];
+  a = Reflectance_Position(data^rest) - last;
+  b = Reflectance_Position(rest) - last;
+  if(n == m){                         // no telling by width
+    n = (a < 0) ? -a : a;
+    m = (b < 0) ? -b : b;
+  }
+  *position = last + ((n <= m) ? a : b);
+  return 1;
+}
+
+void LineHistory_Add(LineHistory_t *h, uint8_t data){
+  uint32_t n, oldest;
+  int32_t position;
+  if(data == 0){
+    h->lost = 1;            // keep what we knew when the line left
+    return;
+  }
+  if(data == 0xFF){
+    return;                 // bar or crossing line, no position in it
+  }
+  if(h->lost){
+    LineHistory_Init(h);    // line is back, old frames no longer apply
+  }
+  if(LineHistory_Line(h, data, &position) == 0){
+    return;
+  }
+  h->newest = (h->newest + 1)&(HISTORY_SIZE - 1);
+  h->position[h->newest] = position;
+  if(h->count < HISTORY_SIZE){
+    h->count = h->count + 1;
+  }
+  n = h->count;
+  if(n > HISTORY_SLOPE_FRAMES){
+    n = HISTORY_SLOPE_FRAMES;
+  }
+  if(n > 1){
+    oldest = (h->newest - (n - 1))&(HISTORY_SIZE - 1);
+    h->slope = (h->position[h->newest] - h->position[oldest])/(int32_t)(n - 1);
+  }else{
+    h->slope = 0;
+  }
+  h->predicted = h->position[h->newest] + h->slope;
+}
+
+int32_t LineHistory_ExitOffset(const LineHistory_t *h){
+  if(h->count == 0) return 0;
+  return h->predicted;
+}
+
+int32_t LineHistory_ExitSide(const LineHistory_t *h){
+  int32_t predicted = LineHistory_ExitOffset(h); // one read, the ISR may be adding a frame
+  if(predicted > HISTORY_CENTER_BAND) return 1;
+  if(predicted < -HISTORY_CENTER_BAND) return -1;
+  return 0;
+}
@@ -0,0 +1,48 @@
+// LineHistory.h
+// Runs on MSP432
+// Short history of line positions seen by the reflectance
+// array, used to remember which side the line left from so
+// the lost-line search can turn toward it.
+
+#ifndef LINEHISTORY_H_
+#define LINEHISTORY_H_
+#include <stdint.h>
+
+#define HISTORY_SIZE 8            // frames kept, power of 2
+#define HISTORY_SLOPE_FRAMES 4    // frames used for the slope
+#define HISTORY_CENTER_BAND 19050 // um, between the 2nd and 3rd sensor from center
+#define HISTORY_JUMP 28600        // um, three sensors, farther in one frame is not the line
+#define HISTORY_TAPE 2            // sensors the line covers, a wider run is a bar or crossing
+
+typedef struct {
+  int32_t position[HISTORY_SIZE]; // um, ring buffer of frames that saw the line
+  uint32_t newest;                // index of the newest position
+  uint32_t count;                 // valid entries, 0 to HISTORY_SIZE
+  uint32_t lost;                  // 1 if frames without the line followed the newest
+  int32_t slope;                  // um per frame, positive is moving right
+  int32_t predicted;              // position one frame after the newest
+  uint32_t jumped;                // frames in a row dropped as too far from the newest
+} LineHistory_t;
+
+// Empty the history
+void LineHistory_Init(LineHistory_t *h);
+
+// Add one frame from the reflectance array
+// Input: data is the 8-bit result from the line sensor
+// Frames with no line keep the history, so the side the
+// line left from is still known while it is lost.  The
+// first frame that sees the line again starts a new history.
+// 0xFF and the part of a bar or crossing seen beside the line
+// are not the line and are left out.
+void LineHistory_Add(LineHistory_t *h, uint8_t data);
+
+// Where the line was headed when it left
+// Output: um, predicted position one frame after the last
+//         sighting, positive right, 0 if none yet
+int32_t LineHistory_ExitOffset(const LineHistory_t *h);
+
+// Which side of the robot the line left from
+// Output: +1 right, -1 left, 0 straight ahead or unknown
+int32_t LineHistory_ExitSide(const LineHistory_t *h);
+
+#endif
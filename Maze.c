@@ -0,0 +1,243 @@
+// Maze.c
+// Runs on MSP432
+// Solves a line maze on a grid.
+// Directions are absolute: 0 is the heading at the start, 1 is
+// a right turn from it, 2 behind, 3 left.  A node is placed at
+// the last node plus the odometry distance along the heading,
+// and snaps to a known node within MAZE_MATCH, which takes out
+// the drift before it adds up.  Paths come from Dijkstra on
+// the edge lengths; with MAZE_NODES small the O(n^2) form is
+// cheaper than a heap.
+
+#include <stdint.h>
+#include "Maze.h"
+#include "Junction.h"
+
+#define INFINITE 0xFFFFFFFF
+
+static const int32_t DX[4] = {0, 1, 0, -1};
+static const int32_t DY[4] = {1, 0, -1, 0};
+
+static int32_t absolute(int32_t v){
+  return (v < 0)? -v : v;
+}
+
+// 1 if node n has an exit that has not been driven
+static uint32_t unexplored(const Maze_t *m, uint32_t n){
+  uint32_t d;
+  for(d = 0; d < 4; d++){
+    if((m->node[n].exits & (1 << d)) && (m->node[n].link[d] == MAZE_NONE)){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// shortest distance in mm from source to every node
+static void dijkstra(const Maze_t *m, uint32_t source, uint32_t *dist){
+  uint8_t done[MAZE_NODES];
+  uint32_t i, d, n, best, cost;
+  for(i = 0; i < m->count; i++){
+    dist[i] = INFINITE;
+    done[i] = 0;
+  }
+  dist[source] = 0;
+  while(1){
+    n = MAZE_NONE;
+    best = INFINITE;
+    for(i = 0; i < m->count; i++){
+      if((done[i] == 0) && (dist[i] < best)){
+        best = dist[i];
+        n = i;
+      }
+    }
+    if(n == MAZE_NONE) return;
+    done[n] = 1;
+    for(d = 0; d < 4; d++){
+      i = m->node[n].link[d];
+      if(i != MAZE_NONE){
+        cost = best + m->node[n].length[d];
+        if(cost < dist[i]) dist[i] = cost;
+      }
+    }
+  }
+}
+
+// direction to leave node n on the shortest path to the node
+// dist was measured from, MAZE_NONE if there is none
+static uint32_t nextHop(const Maze_t *m, uint32_t n, const uint32_t *dist){
+  uint32_t d, i, cost, best = INFINITE, hop = MAZE_NONE;
+  for(d = 0; d < 4; d++){
+    i = m->node[n].link[d];
+    if((i != MAZE_NONE) && (dist[i] != INFINITE)){
+      cost = dist[i] + m->node[n].length[d];
+      if(cost < best){
+        best = cost;
+        hop = d;
+      }
+    }
+  }
+  return hop;
+}
+
+// 1 if an undriven exit of node n could still give a shorter
+// path to the goal, judged by the grid distance from n to the goal
+static uint32_t promising(const Maze_t *m, uint32_t n, const uint32_t *start){
+  const MazeNode_t *g;
+  uint32_t bound;
+  if(m->goal == MAZE_NONE) return 1;
+  if(start[n] == INFINITE) return 0;
+  g = &m->node[m->goal];
+  bound = start[n] + absolute(m->node[n].x - g->x) + absolute(m->node[n].y - g->y);
+  return (bound + MAZE_MATCH < start[m->goal]);
+}
+
+// direction to explore from the current node, MAZE_NONE when done
+// Leftmost undriven exit here, else toward the nearest node that
+// has one.  Once the goal is known only exits that might shorten
+// the path to it count.
+static uint32_t explore(const Maze_t *m){
+  uint32_t start[MAZE_NODES], dist[MAZE_NODES];
+  uint32_t i, d, h = m->heading, target = MAZE_NONE, best = INFINITE;
+  if(m->goal != MAZE_NONE){
+    dijkstra(m, 0, start);
+  }
+  dijkstra(m, m->current, dist);
+  for(i = 0; i < m->count; i++){
+    if(unexplored(m, i) && (dist[i] < best) && promising(m, i, start)){
+      best = dist[i];
+      target = i;
+    }
+  }
+  if(target == MAZE_NONE) return MAZE_NONE;
+  if(target == m->current){
+    for(i = 3; i < 6; i++){       // left, straight, right
+      d = (h + i) & 3;
+      if((m->node[target].exits & (1 << d)) && (m->node[target].link[d] == MAZE_NONE)){
+        return d;
+      }
+    }
+  }
+  dijkstra(m, target, dist);
+  return nextHop(m, m->current, dist);
+}
+
+// fill the route from the start to the goal, 0 if there is none
+static uint32_t solve(Maze_t *m){
+  uint32_t dist[MAZE_NODES];
+  uint32_t n = 0, d;
+  m->routeLength = 0;
+  dijkstra(m, m->goal, dist);
+  if(dist[0] == INFINITE) return 0;
+  while((n != m->goal) && (m->routeLength < MAZE_NODES)){
+    d = nextHop(m, n, dist);
+    m->route[m->routeLength++] = d;
+    n = m->node[n].link[d];
+  }
+  return (n == m->goal);
+}
+
+void Maze_Init(Maze_t *m){
+  uint32_t d;
+  m->phase = MAZE_EXPLORE;
+  m->heading = 0;
+  m->current = 0;
+  m->lastDistance = 0;
+  m->count = 1;
+  m->goal = MAZE_NONE;
+  m->step = 0;
+  m->routeLength = 0;
+  m->node[0].x = 0;
+  m->node[0].y = 0;
+  m->node[0].exits = 1;           // the line ahead
+  for(d = 0; d < 4; d++){
+    m->node[0].link[d] = MAZE_NONE;
+    m->node[0].length[d] = 0;
+  }
+}
+
+uint32_t Maze_Restart(Maze_t *m, int32_t distance){
+  if((m->goal == MAZE_NONE) || (m->routeLength == 0)){
+    return 0;
+  }
+  m->phase = MAZE_FAST;
+  m->heading = m->route[0];
+  m->current = 0;
+  m->lastDistance = distance;
+  m->step = 1;                    // route[0] is the line out of the start
+  return 1;
+}
+
+uint32_t Maze_Node(Maze_t *m, uint8_t exits, uint8_t goal, int32_t distance){
+  uint32_t h = m->heading, back = (h + 2) & 3;
+  uint32_t i, d, n = MAZE_NONE;
+  int32_t len = distance - m->lastDistance;
+  int32_t x, y;
+  if((m->phase == MAZE_SOLVED) || (m->phase == MAZE_FINISHED)){
+    return MAZE_STOP;
+  }
+  if(len < 1) len = 1;
+  x = m->node[m->current].x + DX[h]*len;
+  y = m->node[m->current].y + DY[h]*len;
+  for(i = 0; i < m->count; i++){
+    if(absolute(m->node[i].x - x) + absolute(m->node[i].y - y) < MAZE_MATCH){
+      n = i;
+      break;
+    }
+  }
+  if(n == MAZE_NONE){
+    if(m->count == MAZE_NODES){
+      m->phase = MAZE_FINISHED;   // map full
+      return MAZE_STOP;
+    }
+    n = m->count++;
+    m->node[n].x = x;
+    m->node[n].y = y;
+    m->node[n].exits = 0;
+    if(exits & JUNCTION_LEFT) m->node[n].exits |= 1 << ((h + 3) & 3);
+    if(exits & JUNCTION_STRAIGHT) m->node[n].exits |= 1 << h;
+    if(exits & JUNCTION_RIGHT) m->node[n].exits |= 1 << ((h + 1) & 3);
+    for(d = 0; d < 4; d++){
+      m->node[n].link[d] = MAZE_NONE;
+      m->node[n].length[d] = 0;
+    }
+  }
+  m->node[n].exits |= 1 << back;  // the line just driven
+  m->node[m->current].exits |= 1 << h;
+  m->node[m->current].link[h] = n;
+  m->node[m->current].length[h] = len;
+  m->node[n].link[back] = m->current;
+  m->node[n].length[back] = len;
+  m->current = n;
+  m->lastDistance = distance;
+  d = MAZE_NONE;
+  if(m->phase == MAZE_FAST){
+    if(goal){
+      m->phase = MAZE_FINISHED;
+      return MAZE_STOP;
+    }
+    if(m->step < m->routeLength){
+      d = m->route[m->step++];
+    }
+  }else{
+    if(goal){
+      m->goal = n;                // keep looking while a shortcut may exist
+      for(i = 0; i < 4; i++){
+        if(m->node[n].link[i] == MAZE_NONE){
+          m->node[n].exits &= ~(1 << i);  // the goal patch hides its exits
+        }
+      }
+    }
+    d = explore(m);
+    if((d == MAZE_NONE) && (m->goal != MAZE_NONE) && solve(m)){
+      m->phase = MAZE_SOLVED;
+      return MAZE_STOP;
+    }
+  }
+  if(d == MAZE_NONE){
+    m->phase = MAZE_FINISHED;     // lost the route, or nowhere left to look
+    return MAZE_STOP;
+  }
+  m->heading = d;
+  return (d - h) & 3;
+}
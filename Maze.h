@@ -0,0 +1,69 @@
+// Maze.h
+// Runs on MSP432
+// Solves a line maze on a grid: lines meet at right angles at
+// nodes.  The exploration run maps the maze as a graph, nodes
+// placed by odometry and edges weighted by their length in mm.
+// It takes the leftmost exit not yet driven at each node, and
+// when none is left there it goes back along the known edges to
+// the nearest node that still has one.  After the goal is found
+// it keeps going only to exits that could still shorten the path
+// (grid distance to the goal), then stops.  The fast run follows
+// the shortest known path from the start to the goal.  Plain C,
+// no hardware access.
+
+#ifndef MAZE_H_
+#define MAZE_H_
+#include <stdint.h>
+
+#define MAZE_NODES 64             // nodes the map can hold
+#define MAZE_MATCH 120            // mm, a node this close is the same node
+#define MAZE_NONE 0xFF            // no node
+
+// phase
+#define MAZE_EXPLORE 0            // mapping, heading for the goal
+#define MAZE_SOLVED 1             // at the goal, shortest path known
+#define MAZE_FAST 2               // racing the shortest path
+#define MAZE_FINISHED 3           // fast run done, or no way to the goal
+
+// action at a node, what the robot does next
+#define MAZE_STRAIGHT 0
+#define MAZE_RIGHT 1
+#define MAZE_BACK 2
+#define MAZE_LEFT 3
+#define MAZE_STOP 4
+
+typedef struct {
+  int16_t x, y;                   // mm from the start, y is the start heading
+  uint8_t exits;                  // bit d set if the line leaves in direction d
+  uint8_t link[4];                // node reached in direction d, or MAZE_NONE
+  uint16_t length[4];             // mm to link[d]
+} MazeNode_t;
+
+typedef struct {
+  uint32_t phase;                 // MAZE_EXPLORE ... MAZE_FINISHED
+  uint32_t heading;               // 0 start heading, 1 right of it, 2, 3
+  uint32_t current;               // node the robot last left
+  int32_t lastDistance;           // odometry mm when it left
+  uint32_t count;                 // nodes in the map
+  uint32_t goal;                  // goal node or MAZE_NONE
+  uint32_t step;                  // next entry of route in the fast run
+  uint32_t routeLength;
+  uint8_t route[MAZE_NODES];      // direction to leave each node of the path
+  MazeNode_t node[MAZE_NODES];
+} Maze_t;
+
+// Empty map, the start is node 0 with the line ahead
+void Maze_Init(Maze_t *m);
+
+// Start the fast run from the start node, facing the start heading
+// Output: 1 if a path to the goal is known, 0 otherwise
+uint32_t Maze_Restart(Maze_t *m, int32_t distance);
+
+// Record a node and choose where to go from it
+// Input: exits    JUNCTION_ exits seen, relative to the robot
+//        goal     1 if the node is the goal
+//        distance odometry mm with the axle over the node
+// Output: MAZE_STRAIGHT, MAZE_RIGHT, MAZE_BACK, MAZE_LEFT or MAZE_STOP
+uint32_t Maze_Node(Maze_t *m, uint8_t exits, uint8_t goal, int32_t distance);
+
+#endif
@@ -44,82 +44,73 @@ policies, either expressed or implied, of the FreeBSD Project.
 #include <stdint.h>
 #include "msp.h"
 #include "../inc/CortexM.h"
-#include "../inc/PWM.h"
+#include "PWM.h"
+#include "Motor.h"
+#include "Pins.h"
+#include "RamFunc.h"
+#include "Battery.h"
+#include "MotorCal.h"
+#include "Tachometer.h"
 
 // *******Lab 13 solution*******
 
+// Dead-band compensation, Q15 duty at which each wheel just starts
+// to turn from rest on the floor (index 0 left, 1 right).
+// Nonzero commands are mapped linearly onto [dead-band, 100%], so
+// small commanded speeds still move the robot. Measure by raising
+// the duty of each wheel until it turns; these are starting values.
+RAMDATA static const uint16_t Motor_DeadbandQ15[2] = {
+  2600,   // left
+  2400    // right
+};
+
+// Supply compensation, Q12 ratio of BATTERY_NOMINAL_MV to the
+// pack voltage, set by Motor_Supply.  1.0 until the first reading.
+static uint32_t Supply = 4096;
+
+// Convert a duty in MOTOR_DUTY_FULL units to Q15, apply
+// the dead-band of one wheel and scale for the pack voltage
+RAMFUNC static uint16_t Motor_Compensate(uint16_t duty, uint32_t wheel){
+  uint32_t q;
+  if(duty == 0) return 0;
+  if(duty > MOTOR_DUTY_FULL) duty = MOTOR_DUTY_FULL;
+  q = ((uint32_t)duty<<15)/MOTOR_DUTY_FULL;
+  q = Motor_DeadbandQ15[wheel] + ((q*(PWM_Q15_MAX - Motor_DeadbandQ15[wheel]))>>15);
+  q = (q*Supply)>>12;                 // same motor voltage on any pack
+  if(q > PWM_Q15_MAX) q = PWM_Q15_MAX;
+  return q;
+}
+
+// ------------Motor_Supply------------
+// Scale every later duty so the motors see the voltage they
+// would at BATTERY_NOMINAL_MV.  Commands already applied keep
+// their old scale until the next one.
+// Input: pack voltage, mV, 0 for unknown (no scaling)
+// Output: none
+void Motor_Supply(uint32_t mV){
+  uint32_t scale = 4096;
+  if(mV){
+    scale = (BATTERY_NOMINAL_MV*4096)/mV;
+    if(scale > 8192) scale = 8192;    // half the nominal voltage, the pack is done
+  }
+  Supply = scale;
+}
+
+// Left wheel on P2.7/CCR4, right wheel on P2.6/CCR3,
+// both change at the same PWM period boundary
+RAMFUNC static void Motor_Duty(uint16_t leftDuty, uint16_t rightDuty){
+  PWM_SetDuties(Motor_Compensate(leftDuty, 0), Motor_Compensate(rightDuty, 1));
+}
+
 // ------------Motor_Init------------
 // Initialize GPIO pins for output, which will be
 // used to control the direction of the motors and
 // to enable or disable the drivers.
 // The motors are initially stopped, the drivers
 // are initially powered down, and the PWM speed
-// control is uninitialized.
+// control runs at MOTOR_PWM_HZ with 0% duty.
 // Input: none
 // Output: none
-
-void Read_Command(uint8_t command){
-    uint8_t direction = command & 0x07;
-    uint8_t speed = (command & 0x18) >> 3;
-
-    switch(direction){
-    case 0x00: // STOP
-        Motor_Stop();
-        break;
-
-    case 0x01: // LEFT
-        //fast left turn
-        if (speed == 0x01){
-            Motor_Left(4900, 4900);
-        }
-        // normal left turn
-        else{
-            Motor_Left(3500, 3500);
-        }
-
-        break;
-
-    case 0x02: // RIGHT
-        // fast right turn
-        if (speed == 0x01){
-            Motor_Right(4900, 4900);
-        }
-        else if (speed == 0x10){
-            Motor_Right(14000, 14000);
-        }
-        // normal right turn
-        else{
-            Motor_Right(3500, 3500);
-        }
-        break;
-
-    case 0x03: // FORWARD
-    // center speed
-        if (speed == 0x00) {
-            Motor_Forward(6700, 6700);
-        }
-    // slightly left/right speed
-        else if (speed == 0x01){
-            // slightly left
-            Motor_Forward(6000, 6000);
-        }
-    // slightly right speed
-        else if (speed == 0x02){
-            // slightly right
-            // (t) = (vR  vL)t/b +
-            Motor_Forward(4250, 4250);
-
-        }
-    // center init - mario kart boost
-        else if (speed == 0x03){
-            Motor_Forward(14000, 14000);
-        }
-        break;
-    case 0x07: // BACKWARDS
-       break;
-    }
-}
-
 void Motor_Init(void){
   // write this as part of Lab 13
   
@@ -134,82 +125,142 @@ void Motor_Init(void){
     P3->DIR |= 0xC0;        //3.6, 3.7 -> output
     P5->DIR |= 0x30;        //5.4, 5.5 -> output
 
-    P3->OUT &= ~0xC0;        //set 3.6 and 3.7 to sleep
-    PWM_Init34(14999,0,0);     // PWM
+    Pin_Awake(0, 0);         //set 3.6 and 3.7 to sleep
+    PWM_Init34Hz(MOTOR_PWM_HZ);     // PWM, 0% duty
 
 }
 
 // ------------Motor_Stop------------
 // Stop the motors, power down the drivers, and
 // set the PWM speed control to 0% duty cycle.
+// Same as Motor_Sleep, meant for when the robot is idle.
 // Input: none
 // Output: none
-void Motor_Stop(void){
+RAMFUNC void Motor_Stop(void){
   // write this as part of Lab 13
-  P1->OUT &= ~0xC0;
-  P2->OUT &= ~0xC0;   // off
-  P3->OUT &= ~0xC0;   // low current sleep mode
-  
-  PWM_Duty3(0);
-  PWM_Duty4(0);
+  Motor_Sleep();
+}
+
+// DRV8838 in phase/enable mode
+// nSLEEP EN  PH   outputs
+//   0     x   x   Hi-Z, coast, low current sleep
+//   1     0   x   both low, brake
+//   1     1   0   forward
+//   1     1   1   reverse
+// Waking from sleep takes the driver's wake-up time, so short
+// stops should brake, which keeps the drivers awake.
+
+// ------------Motor_Brake------------
+// Stop the motors quickly by shorting both terminals of each
+// motor.  The drivers stay awake, so the next command takes
+// effect immediately.
+// Input: none
+// Output: none
+// Assumes: Motor_Init() has been called
+RAMFUNC void Motor_Brake(void){
+  Pin_Awake(1, 1);
+  Motor_Duty(0, 0);
+}
+
+// ------------Motor_Halt------------
+// Brake now, for a fail-safe ISR.  Unlike Motor_Brake this does
+// not wait for the PWM period boundary or the TA0_0 interrupt,
+// and it cancels a duty change already staged.
+// Input: none
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Halt(void){
+  Pin_Awake(1, 1);
+  PWM_Off34();
+}
+
+// ------------Motor_Coast------------
+// Let the motors spin freely.  The DRV8838 only leaves its
+// outputs high impedance while asleep, so the next command
+// pays the wake-up time; direction pins are left as they are.
+// Input: none
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Coast(void){
+  Pin_Awake(0, 0);
+}
 
+// ------------Motor_Sleep------------
+// Idle: power down the drivers and set the PWM speed
+// control to 0% duty cycle.
+// Input: none
+// Output: none
+// Assumes: Motor_Init() has been called
+RAMFUNC void Motor_Sleep(void){
+  Pin_Awake(0, 0);    // low current sleep mode
+  Motor_Duty(0, 0);
 }
 
 // ------------Motor_Forward------------
 // Drive the robot forward by running left and
 // right wheels forward with the given duty
 // cycles.
-// Input: leftDuty  duty cycle of left wheel (0 to 14,998)
-//        rightDuty duty cycle of right wheel (0 to 14,998)
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
 // Output: none
 // Assumes: Motor_Init() has been called
-void Motor_Forward(uint16_t leftDuty, uint16_t rightDuty){ 
+RAMFUNC void Motor_Forward(uint16_t leftDuty, uint16_t rightDuty){ 
   // write this as part of Lab 13
 
     P2->OUT |= 0xC0;
-    P3->OUT |= 0xC0;
-    P5->OUT &= ~0x30;
+    Pin_Awake(1, 1);
+    Pin_Direction(0, 0);
+
+    Motor_Duty(leftDuty, rightDuty);
+}
 
-    PWM_Duty3(leftDuty);
-    PWM_Duty4(rightDuty);
+// ------------Motor_ForwardNow------------
+// Drive forward like Motor_Forward, but write the duties into
+// the compare registers at once.  Motor_Forward stages them for
+// TA0_0, which does not run until interrupts are enabled.
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_ForwardNow(uint16_t leftDuty, uint16_t rightDuty){
+  P2->OUT |= 0xC0;
+  Pin_Awake(1, 1);
+  Pin_Direction(0, 0);
+  PWM_Now34(Motor_Compensate(leftDuty, 0), Motor_Compensate(rightDuty, 1));
 }
 
 // ------------Motor_Right------------
 // Turn the robot to the right by running the
 // left wheel forward and the right wheel
 // backward with the given duty cycles.
-// Input: leftDuty  duty cycle of left wheel (0 to 14,998)
-//        rightDuty duty cycle of right wheel (0 to 14,998)
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
 // Output: none
 // Assumes: Motor_Init() has been called
-void Motor_Right(uint16_t leftDuty, uint16_t rightDuty){ 
+RAMFUNC void Motor_Right(uint16_t leftDuty, uint16_t rightDuty){ 
   // write this as part of Lab 13
     P2->OUT |= 0x80;
-    P3->OUT |= 0x80;
-    P5->OUT &= ~0x10;
-    P5->OUT |= 0x20;
+    Pin_Awake(1, 1);
+    Pin_Direction(0, 1);
 
-    PWM_Duty3(leftDuty);
-    PWM_Duty4(rightDuty);
+    Motor_Duty(leftDuty, rightDuty);
 }
 
 // ------------Motor_Left------------
 // Turn the robot to the left by running the
 // left wheel backward and the right wheel
 // forward with the given duty cycles.
-// Input: leftDuty  duty cycle of left wheel (0 to 14,998)
-//        rightDuty duty cycle of right wheel (0 to 14,998)
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
 // Output: none
 // Assumes: Motor_Init() has been called
-void Motor_Left(uint16_t leftDuty, uint16_t rightDuty){ 
+RAMFUNC void Motor_Left(uint16_t leftDuty, uint16_t rightDuty){ 
   // write this as part of Lab 13
    P2->OUT |= 0x40;
-   P3->OUT |= 0x40;
-   P5->OUT |= 0x10;
-   P5->OUT &= ~0x20;
+   Pin_Awake(1, 1);
+   Pin_Direction(1, 0);
 
-   PWM_Duty3(leftDuty);
-   PWM_Duty4(rightDuty);
+   Motor_Duty(leftDuty, rightDuty);
 
 }
 
@@ -217,17 +268,55 @@ void Motor_Left(uint16_t leftDuty, uint16_t rightDuty){
 // Drive the robot backward by running left and
 // right wheels backward with the given duty
 // cycles.
-// Input: leftDuty  duty cycle of left wheel (0 to 14,998)
-//        rightDuty duty cycle of right wheel (0 to 14,998)
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
 // Output: none
 // Assumes: Motor_Init() has been called
-void Motor_Backward(uint16_t leftDuty, uint16_t rightDuty){ 
+RAMFUNC void Motor_Backward(uint16_t leftDuty, uint16_t rightDuty){ 
   // write this as part of Lab 13
   P2->OUT |= 0xC0;
-  P3->OUT |= 0xC0;
-  P5->OUT |= 0x30;
+  Pin_Awake(1, 1);
+  Pin_Direction(1, 1);
+
+  Motor_Duty(leftDuty, rightDuty);
+
+}
 
-  PWM_Duty3(leftDuty);
-  PWM_Duty4(rightDuty);
+// ------------Motor_Drive------------
+// Run each wheel at a signed duty cycle, negative is
+// backward.  Uses Motor_Forward, Motor_Backward, Motor_Left
+// or Motor_Right depending on the signs, and brakes when
+// both duties are 0.
+// Input: leftDuty  duty cycle of left wheel (-14,999 to 14,999)
+//        rightDuty duty cycle of right wheel (-14,999 to 14,999)
+// Output: none
+// Assumes: Motor_Init() has been called
+RAMFUNC void Motor_Drive(int16_t leftDuty, int16_t rightDuty){
+  if((leftDuty == 0)&&(rightDuty == 0)){
+    Motor_Brake();
+  }else if(leftDuty >= 0){
+    if(rightDuty >= 0){
+      Motor_Forward(leftDuty, rightDuty);
+    }else{
+      Motor_Right(leftDuty, -rightDuty);
+    }
+  }else{
+    if(rightDuty >= 0){
+      Motor_Left(-leftDuty, rightDuty);
+    }else{
+      Motor_Backward(-leftDuty, -rightDuty);
+    }
+  }
+}
 
+// ------------Motor_Speed------------
+// Run each wheel at a signed speed, negative is backward,
+// through the measured curve of each motor (MotorCal), so the
+// same speed on both wheels drives straight.  Both 0 brakes.
+// Input: leftSpeed  speed of left wheel, mm/s
+//        rightSpeed speed of right wheel, mm/s
+// Output: none
+// Assumes: Motor_Init() and MotorCal_Init() have been called
+RAMFUNC void Motor_Speed(int16_t leftSpeed, int16_t rightSpeed){
+  Motor_Drive(MotorCal_Duty(TACH_LEFT, leftSpeed), MotorCal_Duty(TACH_RIGHT, rightSpeed));
 }
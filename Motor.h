@@ -0,0 +1,151 @@
+// Motor.h
+// Runs on MSP432
+// Provide mid-level functions that initialize ports and
+// set motor speeds to move the robot.
+// Daniel Valvano
+// July 11, 2019
+
+// Left motor direction connected to P5.4 (J3.29)
+// Left motor PWM connected to P2.7/TA0CCP4 (J4.40)
+// Left motor enable connected to P3.7 (J4.31)
+// Right motor direction connected to P5.5 (J3.30)
+// Right motor PWM connected to P2.6/TA0CCP3 (J4.39)
+// Right motor enable connected to P3.6 (J2.11)
+
+#ifndef MOTOR_H_
+#define MOTOR_H_
+#include <stdint.h>
+
+// PWM frequency of both motors, override with --define=MOTOR_PWM_HZ=
+// The DRV8838 accepts up to 250 kHz; above ~20 kHz is inaudible.
+#ifndef MOTOR_PWM_HZ
+#define MOTOR_PWM_HZ 20000
+#endif
+
+// Duty cycles passed to the Motor_ functions are fractions of
+// MOTOR_DUTY_FULL, independent of the PWM frequency.
+#define MOTOR_DUTY_FULL 15000
+
+// ------------Motor_Drive------------
+// Run each wheel at a signed duty cycle, negative is
+// backward.  Both 0 brakes, see Motor_Brake.
+// Input: leftDuty  duty cycle of left wheel (-14,999 to 14,999)
+//        rightDuty duty cycle of right wheel (-14,999 to 14,999)
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Drive(int16_t leftDuty, int16_t rightDuty);
+
+// ------------Motor_Speed------------
+// Run each wheel at a signed speed, negative is backward,
+// through the measured curve of each motor (MotorCal), so the
+// same speed on both wheels drives straight.  Both 0 brakes.
+// Input: leftSpeed  speed of left wheel, mm/s
+//        rightSpeed speed of right wheel, mm/s
+// Output: none
+// Assumes: Motor_Init() and MotorCal_Init() have been called
+void Motor_Speed(int16_t leftSpeed, int16_t rightSpeed);
+
+// ------------Motor_Supply------------
+// Scale every later duty so the motors see the voltage they
+// would at BATTERY_NOMINAL_MV.  A duty past what the pack can
+// deliver saturates at 100%.
+// Input: pack voltage, mV, 0 for unknown (no scaling)
+// Output: none
+void Motor_Supply(uint32_t mV);
+
+// ------------Motor_Init------------
+// Initialize GPIO pins for output, which will be
+// used to control the direction of the motors and
+// to enable or disable the drivers.
+// The motors are initially stopped, the drivers
+// are initially powered down, and the PWM speed
+// control runs at MOTOR_PWM_HZ with 0% duty.
+// Input: none
+// Output: none
+void Motor_Init(void);
+
+// ------------Motor_Stop------------
+// Stop the motors, power down the drivers, and
+// set the PWM speed control to 0% duty cycle.
+// Same as Motor_Sleep.
+// Input: none
+// Output: none
+void Motor_Stop(void);
+
+// ------------Motor_Brake------------
+// Short both terminals of each motor to stop quickly.
+// Drivers stay awake so the next command is immediate.
+// Input: none
+// Output: none
+void Motor_Brake(void);
+
+// ------------Motor_Halt------------
+// Brake immediately, cancelling any staged duty change.
+// Safe to call from an ISR that preempts TA0_0.
+// Input: none
+// Output: none
+void Motor_Halt(void);
+
+// ------------Motor_Coast------------
+// Let the motors spin freely (drivers asleep, Hi-Z).
+// The next command pays the driver wake-up time.
+// Input: none
+// Output: none
+void Motor_Coast(void);
+
+// ------------Motor_Sleep------------
+// Idle: drivers asleep and 0% duty cycle.
+// Input: none
+// Output: none
+void Motor_Sleep(void);
+
+// ------------Motor_Forward------------
+// Drive the robot forward by running left and
+// right wheels forward with the given duty
+// cycles.
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Forward(uint16_t leftDuty, uint16_t rightDuty);
+
+// ------------Motor_ForwardNow------------
+// Motor_Forward without waiting for the PWM period boundary, for
+// the boot, while interrupts are still off.
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_ForwardNow(uint16_t leftDuty, uint16_t rightDuty);
+
+// ------------Motor_Right------------
+// Turn the robot to the right by running the
+// left wheel forward and the right wheel
+// backward with the given duty cycles.
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Right(uint16_t leftDuty, uint16_t rightDuty);
+
+// ------------Motor_Left------------
+// Turn the robot to the left by running the
+// left wheel backward and the right wheel
+// forward with the given duty cycles.
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Left(uint16_t leftDuty, uint16_t rightDuty);
+
+// ------------Motor_Backward------------
+// Drive the robot backward by running left and
+// right wheels backward with the given duty
+// cycles.
+// Input: leftDuty  duty cycle of left wheel (0 to 14,999)
+//        rightDuty duty cycle of right wheel (0 to 14,999)
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Backward(uint16_t leftDuty, uint16_t rightDuty);
+
+#endif
@@ -0,0 +1,107 @@
+// MotorCal.c
+// Runs on MSP432
+// Motor characterization and its inverse.
+// Each curve holds the steady wheel speed at evenly spaced
+// duties, forced non-decreasing when it is stored, so the inverse
+// is a search for the first point faster than the request and a
+// linear interpolation back to the point before it.  Requests in
+// the dead-band land between the last point that did not turn
+// and the first that did.  Backward is taken to be the mirror
+// of forward.
+
+#include <stdint.h>
+#include "MotorCal.h"
+#include "Motor.h"
+#include "Tachometer.h"
+#include "Flash.h"
+#include "Odometry.h"
+#include "RamFunc.h"
+#include "Robot.h"
+#include "..\inc\Clock.h"
+
+#define MOTORCAL_STEP (MOTOR_DUTY_FULL/(MOTORCAL_POINTS - 1))
+
+static ROBOT_LOCAL const MotorCal_t *Cal; // table in flash, 0 for none
+
+// sum of the words before check
+static uint32_t MotorCal_Sum(const MotorCal_t *c){
+  const uint32_t *p = (const uint32_t *)c;
+  uint32_t i, sum = 0;
+  for(i = 0; i < (sizeof(MotorCal_t)/4) - 1; i++){
+    sum += p[i];
+  }
+  return sum;
+}
+
+// 1 if both wheels turned and reached a useful top speed, a
+// curve of zeros would make every request full duty
+static uint32_t MotorCal_Plausible(const MotorCal_t *c){
+  return (c->speed[TACH_LEFT][MOTORCAL_POINTS - 1] >= MOTORCAL_MIN_TOP) &&
+         (c->speed[TACH_RIGHT][MOTORCAL_POINTS - 1] >= MOTORCAL_MIN_TOP);
+}
+
+uint32_t MotorCal_Init(void){
+  const MotorCal_t *f = (const MotorCal_t *)FLASH_CAL_ADDRESS;
+  Cal = 0;
+  if((f->magic == MOTORCAL_MAGIC) && (f->check == MotorCal_Sum(f)) && MotorCal_Plausible(f)){
+    Cal = f;
+  }
+  return Cal != 0;
+}
+
+uint32_t MotorCal_Run(MotorCal_t *cal){
+  uint32_t i, k, w, sum[2];
+  uint16_t duty;
+  Cal = 0;                            // the old table is about to go
+  for(i = 0; i < MOTORCAL_POINTS; i++){
+    duty = i*MOTORCAL_STEP;
+    Motor_Forward(duty, duty);
+    Clock_Delay1ms(MOTORCAL_SETTLE_MS);
+    sum[TACH_LEFT] = sum[TACH_RIGHT] = 0;
+    for(k = 0; k < MOTORCAL_SAMPLES; k++){
+      Clock_Delay1ms(10);
+      sum[TACH_LEFT] += Tach_Speed(TACH_LEFT);
+      sum[TACH_RIGHT] += Tach_Speed(TACH_RIGHT);
+    }
+    for(w = 0; w < 2; w++){
+      cal->speed[w][i] = sum[w]/MOTORCAL_SAMPLES;
+      if((i > 0) && (cal->speed[w][i] < cal->speed[w][i - 1])){
+        cal->speed[w][i] = cal->speed[w][i - 1]; // a noisy step cannot fold the inverse
+      }
+    }
+  }
+  Motor_Stop();
+  cal->magic = MOTORCAL_MAGIC;
+  cal->check = MotorCal_Sum(cal);
+  if(MotorCal_Plausible(cal) == 0){
+    MotorCal_Init();                  // keep whatever table was there
+    return 2;
+  }
+  if(Flash_Erase() || Flash_Write((const uint32_t *)cal, sizeof(MotorCal_t)/4)){
+    return 1;
+  }
+  return MotorCal_Init() == 0;
+}
+
+RAMFUNC int16_t MotorCal_Duty(uint32_t wheel, int16_t speed){
+  const uint16_t *s;
+  int32_t v = (speed < 0) ? -speed : speed;
+  int32_t duty;
+  uint32_t i;
+  if(v == 0){
+    return 0;
+  }
+  if(Cal == 0){
+    duty = (v*MOTOR_DUTY_FULL)/ODOMETRY_FULL_SPEED;
+    if(duty > MOTOR_DUTY_FULL) duty = MOTOR_DUTY_FULL;
+  }else{
+    s = Cal->speed[wheel];
+    if(v >= s[MOTORCAL_POINTS - 1]){
+      duty = MOTOR_DUTY_FULL;         // as fast as this motor goes
+    }else{
+      for(i = 1; s[i] <= v; i++){}    // s[i-1] <= v < s[i]
+      duty = MOTORCAL_STEP*(i - 1) + (MOTORCAL_STEP*(v - s[i - 1]))/(s[i] - s[i - 1]);
+    }
+  }
+  return (speed < 0) ? -duty : duty;
+}
@@ -0,0 +1,52 @@
+// MotorCal.h
+// Runs on MSP432
+// Duty-to-speed curve of each motor, measured on the robot and
+// kept in flash, and its inverse so callers can ask for a speed.
+// Build with CHARACTERIZE defined, put the robot on a stand with
+// the wheels free, and reset: MotorCal_Run steps both motors
+// through MOTORCAL_POINTS duties, times the wheels with the
+// encoders and writes the curves to flash.  Every later build
+// reads them at MotorCal_Init.  Without a valid table speed is
+// taken as proportional to duty, ODOMETRY_FULL_SPEED at full.
+
+#ifndef MOTORCAL_H_
+#define MOTORCAL_H_
+#include <stdint.h>
+
+#define MOTORCAL_MAGIC 0x4D43414C // "MCAL", a table was written
+#define MOTORCAL_POINTS 16        // duty i*MOTOR_DUTY_FULL/(MOTORCAL_POINTS-1)
+#define MOTORCAL_SETTLE_MS 600    // per step, to reach steady speed
+#define MOTORCAL_SAMPLES 20       // averaged per step, 10 ms apart
+#define MOTORCAL_MIN_TOP 200      // mm/s at full duty, slower is a stalled wheel or no encoder
+
+typedef struct {
+  uint32_t magic;                 // MOTORCAL_MAGIC
+  uint16_t speed[2][MOTORCAL_POINTS]; // mm/s, [TACH_LEFT or TACH_RIGHT][point]
+  uint32_t check;                 // sum of the words above
+} MotorCal_t;
+
+// ------------MotorCal_Init------------
+// Use the table in flash if it is valid: magic and check match
+// and both wheels reach MOTORCAL_MIN_TOP at full duty
+// Input: none
+// Output: 1 if a table was found, 0 if running uncalibrated
+uint32_t MotorCal_Init(void);
+
+// ------------MotorCal_Run------------
+// Measure both motors and store the curves in flash.
+// Takes MOTORCAL_POINTS*(MOTORCAL_SETTLE_MS + 200) ms.
+// Input: table to fill, also the one reported
+// Output: 0 if stored and read back, 1 if the flash write failed,
+//         2 if a wheel never reached MOTORCAL_MIN_TOP, nothing
+//         written and the table already in flash kept
+// Assumes: Motor_Init() and Tach_Init() have been called,
+//          interrupts are enabled and nothing else drives the motors
+uint32_t MotorCal_Run(MotorCal_t *cal);
+
+// ------------MotorCal_Duty------------
+// Duty that runs one motor at a speed
+// Input: TACH_LEFT or TACH_RIGHT, mm/s, negative is backward
+// Output: duty for Motor_Drive, -MOTOR_DUTY_FULL to MOTOR_DUTY_FULL
+int16_t MotorCal_Duty(uint32_t wheel, int16_t speed);
+
+#endif
@@ -0,0 +1,183 @@
+// OS.c
+// Runs on MSP432
+// Small preemptive fixed-priority kernel.
+// Threads share the main stack pointer.  PendSV saves r4-r11 and
+// EXC_RETURN on the running thread's stack (and s16-s31 if that
+// thread was using the FPU), stores SP in RunPt, and restores the
+// thread in NextPt the same way, see osasm.asm.  A periodic task
+// runs as a thread that calls its function and then gives up the
+// CPU in OS_Finish until its next release.
+
+#include <stdint.h>
+#include "msp.h"
+#include "OS.h"
+#include "..\inc\CortexM.h"
+#include "RamFunc.h"
+#include "Trace.h"
+
+typedef struct {
+  uint32_t *sp;                   // saved stack pointer, first for osasm.asm
+  void (*task)(void);
+  uint32_t period;                // ticks, 0 for background
+  uint32_t countdown;             // ticks to the next release
+  uint32_t ready;                 // 1 from release to the end of the job
+  uint32_t misses;                // releases dropped
+} TCB_t;
+
+static TCB_t TCB[OS_TASKS + 1];   // the last one is idle
+#pragma NOINIT(Stacks)
+static uint32_t Stacks[OS_TASKS + 1][OS_STACK_WORDS]; // OS_Stack fills what is read
+static uint32_t Order[OS_TASKS + 1]; // TCB index by priority, highest first
+static uint32_t Count;            // tasks added
+static uint32_t Background;       // 1 once a background task is added
+TCB_t *RunPt;                     // running thread, used by osasm.asm
+TCB_t *NextPt;                    // thread PendSV switches to
+
+void StartOS(void);               // osasm.asm, runs RunPt
+
+// idle thread when there is no background task
+static void OS_Idle(void){
+  while(1){
+    WaitForInterrupt();
+  }
+}
+
+// build a stack that looks like the thread was switched out
+// just before its first instruction
+static void OS_Stack(uint32_t i, void(*pc)(void)){
+  uint32_t *sp = &Stacks[i][OS_STACK_WORDS];
+  *(--sp) = 0x01000000;           // xPSR, Thumb bit
+  *(--sp) = (uint32_t)pc;         // PC
+  *(--sp) = (uint32_t)OS_Idle;    // LR, not used, threads never return
+  *(--sp) = 0x12121212;           // R12
+  *(--sp) = 0x03030303;           // R3
+  *(--sp) = 0x02020202;           // R2
+  *(--sp) = 0x01010101;           // R1
+  *(--sp) = 0x00000000;           // R0
+  *(--sp) = 0xFFFFFFF9;           // EXC_RETURN, thread mode, MSP, no FPU frame
+  *(--sp) = 0x11111111;           // R11
+  *(--sp) = 0x10101010;           // R10
+  *(--sp) = 0x09090909;           // R9
+  *(--sp) = 0x08080808;           // R8
+  *(--sp) = 0x07070707;           // R7
+  *(--sp) = 0x06060606;           // R6
+  *(--sp) = 0x05050505;           // R5
+  *(--sp) = 0x04040404;           // R4
+  TCB[i].sp = sp;
+}
+
+// point NextPt at the highest priority ready thread and pend
+// a switch if it is not the one running
+// Assumes: interrupts are disabled or this is SysTick
+RAMFUNC static void OS_Schedule(void){
+  uint32_t i;
+  TCB_t *t = &TCB[OS_TASKS];      // idle
+  for(i = 0; i < Count; i++){
+    if(TCB[Order[i]].ready){
+      t = &TCB[Order[i]];
+      break;
+    }
+  }
+  if(t != RunPt){
+    NextPt = t;
+    SCB->ICSR = 0x10000000;       // PENDSVSET
+  }
+}
+
+// end of a job, wait for the next release
+static void OS_Finish(void){
+  DisableInterrupts();
+  RunPt->ready = 0;
+  OS_Schedule();
+  EnableInterrupts();             // PendSV switches away here
+}
+
+static void OS_Periodic(void){
+  while(1){
+    RunPt->task();
+    OS_Finish();
+  }
+}
+
+void OS_Init(void){
+  DisableInterrupts();
+  Count = 0;
+  Background = 0;
+  TCB[OS_TASKS].period = 0;
+  TCB[OS_TASKS].ready = 1;
+  TCB[OS_TASKS].misses = 0;
+  OS_Stack(OS_TASKS, OS_Idle);
+}
+
+uint32_t OS_AddTask(void(*task)(void), uint32_t period){
+  uint32_t i = Count;
+  if(i == OS_TASKS) return OS_TASKS;
+  if(period == 0){
+    if(Background) return OS_TASKS;
+    Background = 1;
+  }
+  TCB[i].task = task;
+  TCB[i].period = period;
+  TCB[i].countdown = 1;           // released at the first tick
+  TCB[i].ready = (period == 0);   // background is always ready
+  TCB[i].misses = 0;
+  OS_Stack(i, (period == 0)? task : OS_Periodic);
+  Count = i + 1;
+  return i;
+}
+
+void OS_Launch(uint32_t tick){
+  uint32_t i, j, t;
+  for(i = 0; i < Count; i++){     // rate monotonic, background last
+    Order[i] = i;
+  }
+  for(i = 1; i < Count; i++){     // insertion sort, shorter period first
+    t = Order[i];
+    j = i;
+    while((j > 0) && ((TCB[Order[j - 1]].period == 0) ||
+          ((TCB[t].period != 0) && (TCB[t].period < TCB[Order[j - 1]].period)))){
+      Order[j] = Order[j - 1];
+      j--;
+    }
+    Order[j] = t;
+  }
+  SysTick->CTRL = 0;              // disable SysTick during setup
+  SysTick->LOAD = tick - 1;
+  SysTick->VAL = 0;
+  SCB->SHP[10] = 0xE0;            // PendSV priority 7, lowest
+  SCB->SHP[11] = 0x40;            // SysTick priority 2
+  SysTick->CTRL = 0x00000007;     // enable, core clock, interrupt
+  RunPt = &TCB[OS_TASKS];         // idle until the first tick releases the tasks
+  for(i = 0; i < Count; i++){
+    if(TCB[Order[i]].period == 0){
+      RunPt = &TCB[Order[i]];     // or background
+    }
+  }
+  NextPt = RunPt;
+  StartOS();                      // enables interrupts
+}
+
+// release the periodic tasks, every tick
+RAMFUNC void SysTick_Handler(void){
+  uint32_t i;
+  TRACE_ENTER(TRACE_SYSTICK);
+  for(i = 0; i < Count; i++){
+    if(TCB[i].period){
+      TCB[i].countdown--;
+      if(TCB[i].countdown == 0){
+        TCB[i].countdown = TCB[i].period;
+        if(TCB[i].ready){
+          TCB[i].misses++;        // still running the last job
+        }else{
+          TCB[i].ready = 1;
+        }
+      }
+    }
+  }
+  OS_Schedule();
+  TRACE_EXIT(TRACE_SYSTICK);
+}
+
+uint32_t OS_Misses(uint32_t id){
+  return TCB[id].misses;
+}
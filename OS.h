@@ -0,0 +1,48 @@
+// OS.h
+// Runs on MSP432
+// Small preemptive fixed-priority kernel.
+// Periodic tasks are functions the kernel calls once per period,
+// each call is a job.  Priorities are rate monotonic: the shorter
+// the period, the higher the priority, set when OS_Launch runs.
+// A job still running when its task is released again has missed
+// its deadline (the deadline is the period); that release is
+// dropped and counted.  One background task may be added with
+// period 0.  It never returns and runs whenever no job is ready.
+// SysTick releases the tasks at priority 2, and PendSV switches
+// threads at priority 7, the lowest, so it only runs after every
+// other interrupt has finished.
+
+#ifndef OS_H_
+#define OS_H_
+#include <stdint.h>
+
+#define OS_TASKS 4                // tasks, background included
+#define OS_STACK_WORDS 512        // per task, also holds the frames of nested ISRs
+
+// ------------OS_Init------------
+// Disable interrupts and empty the task table
+// Input: none
+// Output: none
+void OS_Init(void);
+
+// ------------OS_AddTask------------
+// Add a task with its own static stack
+// Input: task   function run once per period, or forever if period is 0
+//        period in ticks, 0 for the background task
+// Output: task id for OS_Misses, or OS_TASKS if the table is full
+//         or a second background task is added
+uint32_t OS_AddTask(void(*task)(void), uint32_t period);
+
+// ------------OS_Launch------------
+// Start SysTick and run the highest priority task.  All periodic
+// tasks are released at the first tick.  Interrupts are enabled.
+// Input: tick in bus cycles (48000 is 1 ms at 48 MHz)
+// Output: none, never returns
+void OS_Launch(uint32_t tick);
+
+// ------------OS_Misses------------
+// Input: id from OS_AddTask
+// Output: releases dropped because the previous job was still running
+uint32_t OS_Misses(uint32_t id);
+
+#endif
@@ -0,0 +1,38 @@
+// Odometry.c
+// Runs on MSP432
+// Dead reckoning from the commanded duty cycles.
+// At duty d the wheel is assumed to move at
+// d*ODOMETRY_FULL_SPEED/MOTOR_DUTY_FULL mm/s, which is the same
+// number of um per ms, so one SysTick adds the average of the
+// two wheels in um.
+
+#include <stdint.h>
+#include "Odometry.h"
+#include "Motor.h"
+
+void Odometry_Init(Odometry_t *o){
+  o->left = 0;
+  o->right = 0;
+  o->distance = 0;
+}
+
+void Odometry_Duty(Odometry_t *o, int16_t leftDuty, int16_t rightDuty){
+  o->left = leftDuty;
+  o->right = rightDuty;
+}
+
+void Odometry_Tick(Odometry_t *o){
+  int32_t duty = (o->left + o->right)/2;
+  o->distance += duty*ODOMETRY_FULL_SPEED/MOTOR_DUTY_FULL;
+}
+
+int32_t Odometry_Distance(const Odometry_t *o){
+  return o->distance/1000;
+}
+
+int32_t Odometry_Steer(const Odometry_t *o){
+  int32_t left = o->left, right = o->right;
+  int32_t sum = ((left < 0)? -left : left) + ((right < 0)? -right : right);
+  if(sum == 0) return 0;
+  return (left - right)*127/sum;
+}
@@ -0,0 +1,37 @@
+// Odometry.h
+// Runs on MSP432
+// Dead reckoning from the commanded duty cycles.  Speed is taken
+// as proportional to duty, which holds once a MotorCal table
+// linearizes the motors; without one, calibrate
+// ODOMETRY_FULL_SPEED by timing a straight run of known length.
+
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+#include <stdint.h>
+
+#define ODOMETRY_FULL_SPEED 1000  // mm/s at MOTOR_DUTY_FULL on both wheels
+
+typedef struct {
+  int16_t left;                   // commanded left duty, negative is backward
+  int16_t right;                  // commanded right duty, negative is backward
+  int32_t distance;               // um travelled, backward subtracts
+} Odometry_t;
+
+// Zero the distance, wheels stopped
+void Odometry_Init(Odometry_t *o);
+
+// Record the duty cycles just sent to the motors
+// Input: leftDuty, rightDuty as given to Motor_Drive
+void Odometry_Duty(Odometry_t *o, int16_t leftDuty, int16_t rightDuty);
+
+// Integrate 1 ms of travel, call from SysTick
+void Odometry_Tick(Odometry_t *o);
+
+// Output: mm travelled since Odometry_Init
+int32_t Odometry_Distance(const Odometry_t *o);
+
+// Output: steering of the current command, -127 full pivot
+//         left to +127 full pivot right, 0 straight or stopped
+int32_t Odometry_Steer(const Odometry_t *o);
+
+#endif
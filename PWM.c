@@ -45,6 +45,14 @@ policies, either expressed or implied, of the FreeBSD Project.
 */
 
 #include "msp.h"
+#include "PWM.h"
+#include "Trace.h"
+#include "RamFunc.h"
+
+#define SMCLK_FREQ 12000000     // Clock_Init48MHz sets SMCLK = 12 MHz
+
+static uint16_t Period34;       // TA0CCR0 for P2.6, P2.7, counts
+static uint16_t Staged3, Staged4; // CCR3, CCR4 waiting for the next period
 
 //***************************PWM_Init1*******************************
 // PWM outputs on P2.4
@@ -160,9 +168,56 @@ void PWM_Init34(uint16_t period, uint16_t duty3, uint16_t duty4){
       TIMER_A0->CCTL[4] = 0x0040;      // CCR2 toggle/reset
       TIMER_A0->CCR[4] = duty4;        // CCR2 duty cycle is duty2/period
       TIMER_A0->CTL = 0x02F0;        // SMCLK=12MHz, divide by 8, up-down mode
+      Period34 = period;
   
 }
 
+//***************************PWM_Init34Hz*******************************
+// PWM outputs on P2.6, P2.7 at a given frequency, 0% duty
+// Inputs:  frequency in Hz (PWM34_MIN_HZ to PWM34_MAX_HZ)
+// Outputs: period in timer counts, 0 if the frequency is out of range
+// SMCLK = 48MHz/4 = 12 MHz, 83.33ns
+// Counter counts up to TA0CCR0 and back down, so the
+// frequency is 12MHz/(2*divider*period).  The smallest divider
+// (ID times EX0) that keeps period within 16 bits is used, which
+// gives the finest duty resolution available at that frequency.
+// 20 kHz: divide by 1, period = 300
+// 50 Hz:  divide by 2, period = 60000
+uint16_t PWM_Init34Hz(uint32_t frequency){
+  uint32_t counts, divider, id, ex;
+  if((frequency < PWM34_MIN_HZ)||(frequency > PWM34_MAX_HZ)) return 0; // bad input
+  counts = SMCLK_FREQ/(2*frequency);  // half period in SMCLK cycles
+  divider = (counts + 0xFFFE)/0xFFFF; // smallest total divider for 16 bits
+  id = 0;
+  while((8u<<id) < divider){           // ID divides by 1, 2, 4 or 8
+    id = id + 1;
+  }
+  ex = (divider + (1<<id) - 1)>>id;   // EX0 divides by 1 to 8
+  P2->DIR |= 0xC0;                    // P2.6, P2.7 output
+  P2->SEL0 |= 0xC0;                   // P2.6, P2.7 Timer0A functions
+  P2->SEL1 &= ~0xC0;                  // P2.6, P2.7 Timer0A functions
+  TIMER_A0->CTL &= ~0x0030;           // halt Timer A0 while reconfiguring
+  Period34 = counts/((1<<id)*ex);
+  TIMER_A0->CCTL[0] = 0x0080;         // CCI0 toggle
+  TIMER_A0->CCR[0] = Period34;
+  TIMER_A0->EX0 = ex - 1;             // divide by ex
+  TIMER_A0->CCTL[3] = 0x0040;         // CCR3 toggle/reset
+  TIMER_A0->CCR[3] = 0;               // 0% duty
+  TIMER_A0->CCTL[4] = 0x0040;         // CCR4 toggle/reset
+  TIMER_A0->CCR[4] = 0;               // 0% duty
+  NVIC->IP[8] = 0x20;                 // TA0_0 is interrupt 8, priority 1
+  NVIC->ISER[0] = 0x00000100;         // enable interrupt 8 in NVIC, armed by PWM_SetDuties
+  TIMER_A0->CTL = 0x0234|(id<<6);     // SMCLK=12MHz, divide by 1<<id, clear, up-down mode
+// bit  mode
+// 9-8  10    TASSEL, SMCLK=12MHz
+// 7-6  id    ID, divide by 1<<id
+// 5-4  11    MC, up-down mode
+// 2    1     TACLR, clear
+// 1    0     TAIE, no interrupt
+// 0          TAIFG
+  return Period34;
+}
+
 //***************************PWM_Duty3*******************************
 // change duty cycle of PWM output on P2.6
 // Inputs:  duty3
@@ -170,7 +225,7 @@ void PWM_Init34(uint16_t period, uint16_t duty3, uint16_t duty4){
 // period of P2.6 is 2*period*666.7ns, duty cycle is duty3/period
 void PWM_Duty3(uint16_t duty3){
     // write this as part of Lab 13
-    if(duty3 >= TIMER_A0->CCR[0]) return; // bad input
+    if(duty3 >= Period34) return; // bad input
     TIMER_A0->CCR[3] = duty3;        // CCR1 duty cycle is duty1/period
   
 }
@@ -181,11 +236,96 @@ void PWM_Duty3(uint16_t duty3){
 // Outputs: none// period of P2.7 is 2*period*666.7ns, duty cycle is duty4/period
 void PWM_Duty4(uint16_t duty4){
     // write this as part of Lab 13
-    if(duty4 >= TIMER_A0->CCR[0]) return; // bad input
+    if(duty4 >= Period34) return; // bad input
     TIMER_A0->CCR[4] = duty4;        // CCR1 duty cycle is duty1/period
   
 }
 
+//***************************PWM_Duty3Q15*******************************
+// change duty cycle of PWM output on P2.6
+// Inputs:  duty3 in Q15, 0 to PWM_Q15_MAX (32767 is 99.997%)
+// Outputs: none
+// scaled onto whatever period PWM_Init34 or PWM_Init34Hz chose
+void PWM_Duty3Q15(uint16_t duty3){
+  if(duty3 > PWM_Q15_MAX) duty3 = PWM_Q15_MAX;
+  TIMER_A0->CCR[3] = ((uint32_t)duty3*Period34)>>15;
+}
+
+//***************************PWM_Duty4Q15*******************************
+// change duty cycle of PWM output on P2.7
+// Inputs:  duty4 in Q15, 0 to PWM_Q15_MAX (32767 is 99.997%)
+// Outputs: none
+// scaled onto whatever period PWM_Init34 or PWM_Init34Hz chose
+void PWM_Duty4Q15(uint16_t duty4){
+  if(duty4 > PWM_Q15_MAX) duty4 = PWM_Q15_MAX;
+  TIMER_A0->CCR[4] = ((uint32_t)duty4*Period34)>>15;
+}
+
+//***************************PWM_SetDuties*******************************
+// change the duty cycles of P2.7 and P2.6 together
+// Inputs:  left  duty of P2.7 (CCR4) in Q15, 0 to PWM_Q15_MAX
+//          right duty of P2.6 (CCR3) in Q15, 0 to PWM_Q15_MAX
+// Outputs: none
+// Both values are staged and the TA0CCR0 interrupt is armed.
+// TA0_0_IRQHandler copies them into CCR4 and CCR3 when the counter
+// reaches TA0CCR0, the top of the up-down count, where both outputs
+// are low.  The next edge of each output uses the new value, so
+// there are no runt pulses and left and right change in the same
+// period.  If called again before the top, the newer values win.
+// Assumes: PWM_Init34Hz has been called
+RAMFUNC void PWM_SetDuties(uint16_t left, uint16_t right){
+  if(left > PWM_Q15_MAX) left = PWM_Q15_MAX;
+  if(right > PWM_Q15_MAX) right = PWM_Q15_MAX;
+  TIMER_A0->CCTL[0] &= ~0x0010;       // disarm while staging
+  Staged4 = ((uint32_t)left*Period34)>>15;
+  Staged3 = ((uint32_t)right*Period34)>>15;
+  TIMER_A0->CCTL[0] = (TIMER_A0->CCTL[0]&~0x0001)|0x0010; // clear CCIFG, arm CCIE
+}
+
+//***************************PWM_Off34*******************************
+// 0% duty on P2.6 and P2.7 right now, for emergencies
+// Inputs:  none
+// Outputs: none
+// Any update staged by PWM_SetDuties is dropped, so it cannot
+// bring the old duties back at the top of the count.  The
+// current period may end with a runt pulse.
+void PWM_Off34(void){
+  TIMER_A0->CCTL[0] &= ~0x0010;       // disarm the staged update
+  Staged3 = 0;
+  Staged4 = 0;
+  TIMER_A0->CCR[3] = 0;
+  TIMER_A0->CCR[4] = 0;
+}
+
+//***************************PWM_Now34*******************************
+// change the duty cycles of P2.7 and P2.6 right now
+// Inputs:  left  duty of P2.7 (CCR4) in Q15, 0 to PWM_Q15_MAX
+//          right duty of P2.6 (CCR3) in Q15, 0 to PWM_Q15_MAX
+// Outputs: none
+// Like PWM_Off34 the compare registers are written directly, so
+// it works with interrupts off, when a PWM_SetDuties would wait
+// for TA0_0.  The current period may end with a runt pulse.
+// Assumes: PWM_Init34Hz has been called
+void PWM_Now34(uint16_t left, uint16_t right){
+  if(left > PWM_Q15_MAX) left = PWM_Q15_MAX;
+  if(right > PWM_Q15_MAX) right = PWM_Q15_MAX;
+  TIMER_A0->CCTL[0] &= ~0x0010;       // disarm the staged update
+  Staged4 = ((uint32_t)left*Period34)>>15;
+  Staged3 = ((uint32_t)right*Period34)>>15;
+  TIMER_A0->CCR[3] = Staged3;
+  TIMER_A0->CCR[4] = Staged4;
+}
+
+// Runs once at the top of the count after each PWM_SetDuties
+RAMFUNC void TA0_0_IRQHandler(void){
+  TRACE_ENTER(TRACE_TA0);
+  TIMER_A0->CCTL[0] &= ~0x0011;       // acknowledge and disarm
+  TIMER_A0->CCR[3] = Staged3;
+  TIMER_A0->CCR[4] = Staged4;
+  TRACE_STAMP(TRACE_PWM);
+  TRACE_EXIT(TRACE_TA0);
+}
+
 //***************************PWM_RobotArmInit*******************************
 // PWM outputs on P2.4/PM_TA0.1 (PMAP from TA1.1), P3.5/PM_UCB2CLK (PMAP from TA1.2), and P5.7/TA2.2/VREF-/VeREF-/C1.6
 // Inputs:  period (333.33ns)
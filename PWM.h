@@ -0,0 +1,88 @@
+// PWM.h
+// Runs on MSP432
+// PWM on P2.4 using TimerA0 TA0.CCR1
+// PWM on P2.5 using TimerA0 TA0.CCR2
+// PWM on P2.6 using TimerA0 TA0.CCR3
+// PWM on P2.7 using TimerA0 TA0.CCR4
+// Jonathan Valvano
+// July 11, 2019
+
+#ifndef PWM_H_
+#define PWM_H_
+#include <stdint.h>
+
+// Range accepted by PWM_Init34Hz. The low end is where the 16-bit
+// period no longer fits with the largest divider, the high end is
+// where the duty resolution drops below about 6 bits.
+#define PWM34_MIN_HZ 2
+#define PWM34_MAX_HZ 100000
+
+// Q15 duty cycle, 0 is 0% and PWM_Q15_MAX is just under 100%
+#define PWM_Q15_MAX 0x7FFF
+
+void PWM_Init1(uint16_t period, uint16_t duty);
+void PWM_Init12(uint16_t period, uint16_t duty1, uint16_t duty2);
+void PWM_Duty1(uint16_t duty1);
+void PWM_Duty2(uint16_t duty2);
+
+//***************************PWM_Init34*******************************
+// PWM outputs on P2.6, P2.7, SMCLK divide by 8, up-down mode
+// Inputs:  period (1.333us)
+//          duty3
+//          duty4
+// Outputs: none
+void PWM_Init34(uint16_t period, uint16_t duty3, uint16_t duty4);
+
+//***************************PWM_Init34Hz*******************************
+// PWM outputs on P2.6, P2.7 at a given frequency, 0% duty
+// Inputs:  frequency in Hz (PWM34_MIN_HZ to PWM34_MAX_HZ)
+// Outputs: period in timer counts (the duty resolution),
+//          0 if the frequency is out of range
+uint16_t PWM_Init34Hz(uint32_t frequency);
+
+void PWM_Duty3(uint16_t duty3);
+void PWM_Duty4(uint16_t duty4);
+
+//***************************PWM_Duty3Q15*******************************
+// change duty cycle of PWM output on P2.6
+// Inputs:  duty3 in Q15 (0 to PWM_Q15_MAX)
+// Outputs: none
+void PWM_Duty3Q15(uint16_t duty3);
+
+//***************************PWM_Duty4Q15*******************************
+// change duty cycle of PWM output on P2.7
+// Inputs:  duty4 in Q15 (0 to PWM_Q15_MAX)
+// Outputs: none
+void PWM_Duty4Q15(uint16_t duty4);
+
+//***************************PWM_SetDuties*******************************
+// change the duty cycles of P2.7 and P2.6 together at the next
+// period boundary (top of the up-down count)
+// Inputs:  left  duty of P2.7 (CCR4) in Q15, 0 to PWM_Q15_MAX
+//          right duty of P2.6 (CCR3) in Q15, 0 to PWM_Q15_MAX
+// Outputs: none
+void PWM_SetDuties(uint16_t left, uint16_t right);
+
+//***************************PWM_Off34*******************************
+// 0% duty on P2.6 and P2.7 right now, dropping any staged update
+// Inputs:  none
+// Outputs: none
+void PWM_Off34(void);
+
+//***************************PWM_Now34*******************************
+// change the duty cycles of P2.7 and P2.6 right now, dropping any
+// staged update, for when interrupts are off (boot)
+// Inputs:  left  duty of P2.7 (CCR4) in Q15, 0 to PWM_Q15_MAX
+//          right duty of P2.6 (CCR3) in Q15, 0 to PWM_Q15_MAX
+// Outputs: none
+void PWM_Now34(uint16_t left, uint16_t right);
+
+void PWM_RobotArmInit(uint16_t period, uint16_t duty0, uint16_t duty1, uint16_t duty2);
+void PWM_RobotArmDuty0(uint16_t duty0);
+uint16_t PWM_RobotArmGetDuty0(void);
+void PWM_RobotArmDuty1(uint16_t duty1);
+uint16_t PWM_RobotArmGetDuty1(void);
+void PWM_RobotArmDuty2(uint16_t duty2);
+uint16_t PWM_RobotArmGetDuty2(void);
+
+#endif
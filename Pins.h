@@ -0,0 +1,47 @@
+// Pins.h
+// Runs on MSP432
+// Single-bit access to output pins through the Cortex-M4
+// peripheral bit-band region.  Each pin has its own 32-bit alias
+// word, so a write changes only that bit in one bus cycle, with no
+// read-modify-write of the port.  Pins written from both an ISR and
+// the main loop (Port 5 has the reflectance emitters and the motor
+// direction pins) cannot be corrupted by an interrupt landing
+// between the read and the write, and no critical section is needed.
+
+#ifndef PINS_H_
+#define PINS_H_
+#include <stdint.h>
+#include "msp.h"
+
+// alias word of bit b of peripheral register x
+#ifndef BITBAND_PERI
+#define BITBAND_PERI(x, b) (*((volatile uint32_t *)(0x42000000 + \
+        (((uint32_t)&(x)) - 0x40000000)*32 + (b)*4)))
+#endif
+
+#define EVEN_EMITTER BITBAND_PERI(P5->OUT, 3)  // P5.3 CTRL EVEN, IR LEDs 2,4,6,8
+#define ODD_EMITTER  BITBAND_PERI(P9->OUT, 2)  // P9.2 CTRL ODD, IR LEDs 1,3,5,7
+#define LEFT_DIR     BITBAND_PERI(P5->OUT, 4)  // P5.4 left motor, 1 is backward
+#define RIGHT_DIR    BITBAND_PERI(P5->OUT, 5)  // P5.5 right motor, 1 is backward
+#define LEFT_SLEEP   BITBAND_PERI(P3->OUT, 7)  // P3.7 left driver nSLEEP, 1 is awake
+#define RIGHT_SLEEP  BITBAND_PERI(P3->OUT, 6)  // P3.6 right driver nSLEEP, 1 is awake
+
+// Turn the 8 IR LEDs of the reflectance array on (1) or off (0)
+static inline void Pin_Emitters(uint32_t on){
+  EVEN_EMITTER = on;
+  ODD_EMITTER = on;
+}
+
+// Set the direction of each wheel, 0 forward, 1 backward
+static inline void Pin_Direction(uint32_t left, uint32_t right){
+  LEFT_DIR = left;
+  RIGHT_DIR = right;
+}
+
+// Wake (1) or sleep (0) each DRV8838 driver
+static inline void Pin_Awake(uint32_t left, uint32_t right){
+  LEFT_SLEEP = left;
+  RIGHT_SLEEP = right;
+}
+
+#endif
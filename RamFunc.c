@@ -0,0 +1,26 @@
+// RamFunc.c
+// Runs on MSP432
+// Vector table in SRAM for the RUN_FROM_RAM build.
+// VTOR needs the table aligned to its size rounded up to a power
+// of two, 256 bytes here; .vtable sits at the start of SRAM.
+
+#include <stdint.h>
+#include "msp.h"
+#include "RamFunc.h"
+
+#ifdef RUN_FROM_RAM
+extern void (* const interruptVectors[])(void); // startup_msp432p401r_ccs.c
+
+#pragma DATA_SECTION(RamVectors, ".vtable")
+static void (*RamVectors[RAMFUNC_VECTORS])(void);
+#endif
+
+void RamFunc_Init(void){
+#ifdef RUN_FROM_RAM
+  uint32_t i;
+  for(i = 0; i < RAMFUNC_VECTORS; i++){
+    RamVectors[i] = interruptVectors[i];
+  }
+  SCB->VTOR = (uint32_t)RamVectors;
+#endif
+}
@@ -0,0 +1,40 @@
+// RamFunc.h
+// Runs on MSP432
+// Build option RUN_FROM_RAM: the interrupt handlers and the
+// per-frame path run from SRAM instead of flash.  At 48 MHz the
+// flash needs a wait state on every fetch the buffer misses, so
+// branchy code like get_next_state stalls; SRAM has none.
+//   RAMFUNC   code, into .TI.ramfunc, copied to SRAM_CODE at boot
+//   RAMDATA   read-only tables, into .data, copied to SRAM_DATA
+// The vector table moves to .vtable (0x20000000) in RamFunc_Init,
+// so exception entry fetches the handler address from SRAM too.
+// Without RUN_FROM_RAM both macros are empty and RamFunc_Init
+// does nothing.  Build with LATENCY_TRACE as well to compare the
+// cycles per handler (Trace_Average) between the two builds.
+
+#ifndef RAMFUNC_H_
+#define RAMFUNC_H_
+#include <stdint.h>
+
+#ifdef RUN_FROM_RAM
+#if defined(__TI_COMPILER_VERSION__) && (__TI_COMPILER_VERSION__ < 15009000)
+#error "RUN_FROM_RAM needs .TI.ramfunc, TI ARM compiler 15.9 or later"
+#endif
+#define RAMFUNC __attribute__((ramfunc))
+#define RAMDATA __attribute__((section(".data")))
+#else
+#define RAMFUNC
+#define RAMDATA
+#endif
+
+// system exceptions and MSP432P401R interrupts, through PORT6
+#define RAMFUNC_VECTORS (16 + 41)
+
+// ------------RamFunc_Init------------
+// Copy the vector table from flash to SRAM and point VTOR at it.
+// Input: none
+// Output: none
+// Assumes: interrupts are disabled
+void RamFunc_Init(void);
+
+#endif
@@ -0,0 +1,64 @@
+// ReflectFilter.c
+// Runs on MSP432
+// Per-sensor majority vote, all 8 sensors at once (SWAR).
+// For 3 frames a, b, c the vote is (a&b)|(a&c)|(b&c).  For 5 or
+// 7 the frames go through bit-sliced adders: ones, twos and
+// fours hold bit 0, 1 and 2 of the count for every sensor, and
+// the vote compares that count against (REFLECT_FILTER+1)/2.
+
+#include <stdint.h>
+#include "ReflectFilter.h"
+#include "RamFunc.h"
+
+#if (REFLECT_FILTER != 1) && (REFLECT_FILTER != 3) && (REFLECT_FILTER != 5) && (REFLECT_FILTER != 7)
+#error "REFLECT_FILTER must be 1, 3, 5 or 7"
+#endif
+
+void Filter_Init(ReflectFilter_t *f){
+  uint32_t i;
+  for(i = 0; i < 8; i++){
+    f->frame[i] = 0;
+  }
+  f->primed = 0;
+}
+
+RAMFUNC uint8_t Filter_Majority(ReflectFilter_t *f, uint8_t data){
+#if REFLECT_FILTER == 1
+  return data;
+#else
+  uint8_t vote;
+  uint32_t i;
+#if REFLECT_FILTER > 3
+  uint8_t ones, twos, fours, carry;
+#endif
+  if(f->primed == 0){             // first frame, nothing to vote against
+    for(i = 0; i < REFLECT_FILTER - 1; i++){
+      f->frame[i] = data;
+    }
+    f->primed = 1;
+  }
+#if REFLECT_FILTER == 3
+  vote = (data & f->frame[0])|(data & f->frame[1])|(f->frame[0] & f->frame[1]);
+#else
+  ones = data;
+  twos = 0;
+  fours = 0;
+  for(i = 0; i < REFLECT_FILTER - 1; i++){
+    carry = ones & f->frame[i];
+    ones = ones ^ f->frame[i];
+    fours = fours | (twos & carry);
+    twos = twos ^ carry;
+  }
+#if REFLECT_FILTER == 5
+  vote = fours | (twos & ones);   // count >= 3
+#else
+  vote = fours;                   // count >= 4
+#endif
+#endif
+  for(i = REFLECT_FILTER - 1; i > 1; i--){
+    f->frame[i - 1] = f->frame[i - 2];
+  }
+  f->frame[0] = data;
+  return vote;
+#endif
+}
@@ -0,0 +1,32 @@
+// ReflectFilter.h
+// Runs on MSP432
+// Per-sensor majority vote over the last REFLECT_FILTER frames
+// of the reflectance array.  A bit that reads differently for
+// one frame, a scuff or a glint off the floor, is voted out
+// before the pattern is classified.  A real change of the line
+// gets through (REFLECT_FILTER-1)/2 frames later.
+
+#ifndef REFLECTFILTER_H_
+#define REFLECTFILTER_H_
+#include <stdint.h>
+
+// Frames in the vote: 1 (off), 3, 5 or 7, override with --define=REFLECT_FILTER=
+#ifndef REFLECT_FILTER
+#define REFLECT_FILTER 3
+#endif
+
+typedef struct {
+  uint8_t frame[8];               // previous raw frames, newest first
+  uint32_t primed;                // 1 once frame[] holds real data
+} ReflectFilter_t;
+
+// Forget the previous frames
+void Filter_Init(ReflectFilter_t *f);
+
+// Vote one frame
+// Input: data is the 8-bit result from the line sensor
+// Output: each bit set if it was set in most of the last
+//         REFLECT_FILTER frames, data included
+uint8_t Filter_Majority(ReflectFilter_t *f, uint8_t data);
+
+#endif
@@ -55,8 +55,11 @@ policies, either expressed or implied, of the FreeBSD Project.
 #include <stdint.h>
 #include "msp432.h"
 #include "..\inc\Clock.h"
+#include "Pins.h"
+#include "Trace.h"
+#include "RamFunc.h"
 
-const uint32_t weight[8] = {-33400,-23800,-14300,-4800,4800,14300,23800,33400};
+RAMDATA const int32_t weight[8] = {-33400,-23800,-14300,-4800,4800,14300,23800,33400};
 
 // ------------Reflectance_Init------------
 // Initialize the GPIO pins associated with the QTR-8RC
@@ -78,8 +81,7 @@ void Reflectance_Init(void){
 
       P7->DIR &= ~0xFF; //make P7 IN
 
-      P9->OUT &= ~0x04; // TURN OFF SENSOR LEDS
-      P5->OUT &= ~0x08;
+      Pin_Emitters(0);  // TURN OFF SENSOR LEDS
 }
 
 // ------------Reflectance_Read------------
@@ -97,8 +99,7 @@ uint8_t Reflectance_Read(uint32_t time){
     uint8_t result;
     // write this as part of Lab 6
 
-    P5->OUT |= 0x08; // TURN ON LEDS
-    P9->OUT |= 0x04;
+    Pin_Emitters(1); // TURN ON LEDS
 
     P7->DIR |= 0xFF; // MAKE
 
@@ -109,8 +110,7 @@ uint8_t Reflectance_Read(uint32_t time){
 
     result = P7->IN & 0xFF; // replace this line
 
-    P5->OUT &= ~0x08; // TURN OFF LEDS
-    P9->OUT &= ~0x04;
+    Pin_Emitters(0); // TURN OFF LEDS
 
     return result;
 }
@@ -139,8 +139,9 @@ uint8_t Reflectance_Center(uint32_t time){
 
 // Perform sensor integration
 // Input: data is 8-bit result from line sensor
-// Output: position in 0.1mm relative to center of line
-int32_t Reflectance_Position(uint8_t data){
+// Output: position in um (0.001mm) relative to center of line,
+//         +-33400 at the outer sensors, 0 if no line is seen
+RAMFUNC int32_t Reflectance_Position(uint8_t data){
     // write this as part of Lab 6
      int pos[8];
      int idx = 0;
@@ -157,6 +158,9 @@ int32_t Reflectance_Position(uint8_t data){
          weightedSum += pos[idx] * weight[idx];
      }
 
+     if(sum == 0){
+         return 0;        // no line under the array
+     }
      return (weightedSum/sum); // replace this line
 }
 
@@ -169,10 +173,10 @@ int32_t Reflectance_Position(uint8_t data){
 // Input: none
 // Output: none
 // Assumes: Reflectance_Init() has been called
-void Reflectance_Start(void){
+RAMFUNC void Reflectance_Start(void){
       // write this as part of Lab 6
-      P5->OUT |= 0x08; // TURN ON LEDS
-      P9->OUT |= 0x04;
+      TRACE_STAMP(TRACE_START);
+      Pin_Emitters(1); // TURN ON LEDS
 
       P7->DIR |= 0xFF; // MAKE P7 Outputs
 
@@ -190,13 +194,13 @@ void Reflectance_Start(void){
 // Output: sensor readings
 // Assumes: Reflectance_Init() has been called
 // Assumes: Reflectance_Start() was called 1 ms ago
-uint8_t Reflectance_End(void){
+RAMFUNC uint8_t Reflectance_End(void){
     // write this as part of Lab 10
     uint8_t res;
     res = P7->IN & 0xFF; // replace this line
+    TRACE_STAMP(TRACE_END);
 
-    P5->OUT &= ~0x08; // TURN OFF LEDS
-    P9->OUT &= ~0x04;
+    Pin_Emitters(0); // TURN OFF LEDS
     return res; // replace this line
 }
 
@@ -0,0 +1,59 @@
+// Robot.h
+// Runs on MSP432
+// Hooks that let the host simulator (sim/) run many copies of the
+// firmware at once and try other tunings.  On the robot they cost
+// nothing:
+//   ROBOT_LOCAL  storage class of the firmware's global state.  The
+//                simulator makes it _Thread_local, and each worker
+//                thread runs one robot at a time.
+//   ROBOT_TUNE   output or dwell of an FSM state as the fsm[] table
+//                gives it.  The simulator substitutes the parameter
+//                set of the run.
+//   ROBOT_PARAM  a controller constant, the same way.
+// make -C sim suite runs the firmware on the course library in
+// sim/courses, the benchmark for every change to it.
+// Build option FSM_TUNED: take the outputs, dwells and constants
+// from FsmTuned.h, written by the optimizer in sim/ (tune), in
+// place of fsm[] and the #defines.
+
+#ifndef ROBOT_H_
+#define ROBOT_H_
+#include <stdint.h>
+
+#ifndef ROBOT_LOCAL
+#define ROBOT_LOCAL
+#endif
+
+// fields of a state for ROBOT_TUNE
+#define ROBOT_LEFT 0              // left duty
+#define ROBOT_RIGHT 1             // right duty
+#define ROBOT_DELAY 2             // dwell, ms
+
+// constants for ROBOT_PARAM, each named after its #define
+#define ROBOT_SLIGHT_BAND 0       // LineFollowFSMmain.c
+#define ROBOT_STRONG_BAND 1       // LineFollowFSMmain.c
+#define ROBOT_GAP_MM 2            // LineFollowFSMmain.c
+#define ROBOT_ESTIMATOR_ALPHA 3   // LineEstimator.h
+#define ROBOT_ESTIMATOR_BETA 4    // LineEstimator.h
+#define ROBOT_GOVERNOR_MAX_DUTY 5 // SpeedGovernor.h
+#define ROBOT_PROFILE_FAST 6      // SpeedProfile.h
+#define ROBOT_PROFILE_SLOW 7      // SpeedProfile.h
+#define ROBOT_PARAMS 8
+
+#ifdef FSM_TUNED
+#include "FsmTuned.h"             // defines ROBOT_TUNE and ROBOT_PARAM
+#endif
+
+// Input: index into fsm[], ROBOT_LEFT to ROBOT_DELAY, table value
+// Output: the value to use
+#ifndef ROBOT_TUNE
+#define ROBOT_TUNE(state, field, value) (value)
+#endif
+
+// Input: ROBOT_SLIGHT_BAND to ROBOT_PROFILE_SLOW, by name, and the #define
+// Output: the value to use
+#ifndef ROBOT_PARAM
+#define ROBOT_PARAM(id, value) (value)
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+// SpeedGovernor.c
+// Runs on MSP432
+// Raises the straight-line duty cycle while the line stays
+// centered and steady under the reflectance array, and backs
+// off as soon as the position starts to wander.
+// The mean and variance of the position over the last
+// GOVERNOR_WINDOW frames are kept as running sums, so each
+// frame costs one subtract and one add.  Positions are kept
+// in 0.1mm so the sum of squares fits in 32 bits.
+
+#include <stdint.h>
+#include "SpeedGovernor.h"
+#include "Robot.h"
+#include "..\inc\Reflectance.h"
+
+void Governor_Init(SpeedGovernor_t *g){
+  g->index = 0;
+  g->count = 0;
+  g->sum = 0;
+  g->sumSquares = 0;
+  g->steady = 0;
+  g->boost = 0;
+}
+
+void Governor_Add(SpeedGovernor_t *g, uint8_t data, int16_t base){
+  int32_t x, old, mean, variance, headroom;
+  if(data == 0){
+    Governor_Init(g);       // lost the line, start over at base speed
+    return;
+  }
+  x = Reflectance_Position(data)/100;   // um to 0.1mm
+  if(g->count == GOVERNOR_WINDOW){
+    old = g->position[g->index];
+    g->sum -= old;
+    g->sumSquares -= old*old;
+  }else{
+    g->count = g->count + 1;
+  }
+  g->position[g->index] = x;
+  g->sum += x;
+  g->sumSquares += x*x;
+  g->index = (g->index + 1)&(GOVERNOR_WINDOW - 1);
+  if(g->count < GOVERNOR_WINDOW) return;  // not enough frames yet
+  mean = g->sum/GOVERNOR_WINDOW;
+  variance = (int32_t)(g->sumSquares/GOVERNOR_WINDOW) - mean*mean;
+  if((variance > GOVERNOR_VAR_DRIFT)||(mean > GOVERNOR_MEAN_BAND)||(mean < -GOVERNOR_MEAN_BAND)){
+    g->steady = 0;          // drifting, back off before the line is lost
+    if(g->boost > GOVERNOR_RAMP_DOWN){
+      g->boost = g->boost - GOVERNOR_RAMP_DOWN;
+    }else{
+      g->boost = 0;
+    }
+  }else if(variance < GOVERNOR_VAR_STRAIGHT){
+    g->steady = g->steady + 1;
+    headroom = ROBOT_PARAM(ROBOT_GOVERNOR_MAX_DUTY, GOVERNOR_MAX_DUTY) - base;
+    if(headroom < 0){
+      headroom = 0;
+    }
+    if(g->steady > GOVERNOR_HOLD){
+      if(g->boost + GOVERNOR_RAMP_UP < headroom){
+        g->boost = g->boost + GOVERNOR_RAMP_UP;
+      }else{
+        g->boost = headroom;  // above this it would only be clipped
+      }
+    }
+  }
+}
+
+int16_t Governor_Duty(const SpeedGovernor_t *g, int16_t base){
+  int32_t duty = base + g->boost;
+  int32_t max = ROBOT_PARAM(ROBOT_GOVERNOR_MAX_DUTY, GOVERNOR_MAX_DUTY);
+  if(duty > max){
+    duty = max;
+  }
+  return duty;
+}
@@ -0,0 +1,46 @@
+// SpeedGovernor.h
+// Runs on MSP432
+// Raises the straight-line duty cycle while the line stays
+// centered and steady under the reflectance array, and backs
+// off as soon as the position starts to wander.
+
+#ifndef SPEEDGOVERNOR_H_
+#define SPEEDGOVERNOR_H_
+#include <stdint.h>
+
+#define GOVERNOR_WINDOW 16        // frames in the sliding window, power of 2
+#define GOVERNOR_MEAN_BAND 30     // 0.1mm, |mean| must stay below this to count as centered
+#define GOVERNOR_VAR_STRAIGHT 600 // 0.1mm^2, variance below this is a straight
+#define GOVERNOR_VAR_DRIFT 1500   // 0.1mm^2, variance above this starts backing off
+#define GOVERNOR_HOLD 20          // steady frames before the ramp starts
+#define GOVERNOR_RAMP_UP 100      // duty added per steady frame
+#define GOVERNOR_RAMP_DOWN 1000   // duty removed per drifting frame
+#define GOVERNOR_MAX_DUTY 14000   // cap on the governed duty, base plus boost
+
+typedef struct {
+  int16_t position[GOVERNOR_WINDOW]; // 0.1mm, one per frame
+  uint32_t index;                 // next slot to write
+  uint32_t count;                 // valid entries, 0 to GOVERNOR_WINDOW
+  int32_t sum;                    // 0.1mm, sum of the window
+  uint32_t sumSquares;            // 0.1mm^2, sum of squares of the window
+  uint32_t steady;                // consecutive centered, steady frames
+  uint16_t boost;                 // duty added to the base straight speed
+} SpeedGovernor_t;
+
+// Start with an empty window and no boost
+void Governor_Init(SpeedGovernor_t *g);
+
+// Add one frame from the reflectance array
+// Input: data is the 8-bit result from the line sensor
+//        base duty of the straight state
+// A frame with no line empties the window and drops the boost.
+// The boost never grows past GOVERNOR_MAX_DUTY minus base, so
+// the first drifting frame lowers the duty.
+void Governor_Add(SpeedGovernor_t *g, uint8_t data, int16_t base);
+
+// Straight-line duty with the current boost
+// Input: base duty of the straight state
+// Output: base plus boost, at most GOVERNOR_MAX_DUTY
+int16_t Governor_Duty(const SpeedGovernor_t *g, int16_t base);
+
+#endif
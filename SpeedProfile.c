@@ -0,0 +1,32 @@
+// SpeedProfile.c
+// Turns a lap of curvature samples into a straight-line duty
+// for each segment of the lap.  Plain C with no hardware access,
+// shared by the robot (Track.c) and the host tool in tools/.
+
+#include <stdint.h>
+#include "SpeedProfile.h"
+#include "Robot.h"
+
+void SpeedProfile_Compute(const int8_t *curvature, uint32_t n, int16_t *speed){
+  uint32_t i, pass;
+  int32_t c, limit;
+  int32_t fast = ROBOT_PARAM(ROBOT_PROFILE_FAST, PROFILE_FAST);
+  int32_t slow = ROBOT_PARAM(ROBOT_PROFILE_SLOW, PROFILE_SLOW);
+  for(i = 0; i < n; i++){
+    c = curvature[i];
+    if(c < 0) c = -c;
+    if(c > PROFILE_TIGHT) c = PROFILE_TIGHT;
+    speed[i] = fast - (fast - slow)*c/PROFILE_TIGHT;
+  }
+  // two rounds so limits carry across the start of the lap
+  for(pass = 0; pass < 2; pass++){
+    for(i = n; i > 0; i--){       // brake before corners
+      limit = speed[i % n] + PROFILE_BRAKE;
+      if(speed[i - 1] > limit) speed[i - 1] = limit;
+    }
+    for(i = 1; i <= n; i++){      // accelerate out of them
+      limit = speed[i - 1] + PROFILE_ACCEL;
+      if(speed[i % n] > limit) speed[i % n] = limit;
+    }
+  }
+}
@@ -0,0 +1,29 @@
+// SpeedProfile.h
+// Turns a lap of curvature samples into a straight-line duty
+// for each segment of the lap.  Plain C with no hardware access,
+// shared by the robot (Track.c) and the host tool in tools/.
+
+#ifndef SPEEDPROFILE_H_
+#define SPEEDPROFILE_H_
+#include <stdint.h>
+
+#define PROFILE_SEGMENT_MM 50     // lap distance covered by one entry
+#define PROFILE_MAX_SEGMENTS 256  // 12.8 m of lap
+#define PROFILE_FAST 14000        // duty on a straight
+#define PROFILE_SLOW 6000         // duty at PROFILE_TIGHT curvature and beyond
+#define PROFILE_TIGHT 64          // |curvature| treated as the tightest corner
+#define PROFILE_BRAKE 600         // duty the robot can shed per segment
+#define PROFILE_ACCEL 300         // duty the robot can gain per segment
+
+// Compute the duty of each segment
+// Input: curvature  one signed sample per segment, -127 to 127
+//        n          number of segments in the lap, 1 to PROFILE_MAX_SEGMENTS
+// Output: speed     duty for each segment
+// Corners get a duty that falls linearly with |curvature|.  A
+// backward pass then lowers the segments before each corner so
+// the robot has slowed by the time it arrives, and a forward
+// pass limits how fast it speeds up after.  Both passes wrap
+// around the end of the lap.
+void SpeedProfile_Compute(const int8_t *curvature, uint32_t n, int16_t *speed);
+
+#endif
@@ -0,0 +1,94 @@
+// Tachometer.c
+// Runs on MSP432
+// Encoder edge timing on TimerA3.
+// The 16-bit timer runs continuously at 375 kHz and wraps every
+// 175 ms.  Wraps between two edges are counted by TA3_N, so a
+// period is wraps*65536 + this capture - last capture.  Two
+// wraps with no edge mean the wheel has stopped.  Every edge also
+// moves the axle center half of TACH_UM_PER_EDGE.
+
+#include <stdint.h>
+#include "msp.h"
+#include "Tachometer.h"
+
+static uint16_t Last[2];          // capture at the last edge
+static uint32_t Wraps[2];         // timer wraps since the last edge
+static uint32_t Period[2];        // 375 kHz ticks between edges, 0 stopped
+static uint32_t Travel;           // um of wheel travel, both wheels, short of 2 mm
+static uint32_t Distance;         // mm driven by the axle center
+
+void Tach_Init(void){
+  P10->SEL0 |= 0x30;
+  P10->SEL1 &= ~0x30;                 // P10.4 TA3CCP0, P10.5 TA3CCP1
+  P10->DIR &= ~0x30;
+  TIMER_A3->CTL &= ~0x0030;           // halt
+  TIMER_A3->EX0 = 0x0003;             // /4
+  TIMER_A3->CCTL[0] = 0x4910;
+  TIMER_A3->CCTL[1] = 0x4910;
+// bit  mode
+// 15-14 01   CM, capture on rising edge
+// 13-12 00   CCIS, CCIxA pin
+// 11   1     SCS, synchronous capture
+// 8    1     CAP, capture mode
+// 4    1     CCIE, interrupt on capture
+  Period[0] = Period[1] = 0;
+  Wraps[0] = Wraps[1] = 2;            // stopped until two edges
+  Travel = 0;
+  Distance = 0;
+  NVIC->IP[14] = 0x40;                // TA3_0, priority 2
+  NVIC->IP[15] = 0x40;                // TA3_N
+  NVIC->ISER[0] = 0x0000C000;         // enable IRQ 14 and 15
+  TIMER_A3->CTL = 0x02E6;
+// bit  mode
+// 9-8  10    TASSEL, SMCLK=12MHz
+// 7-6  11    ID, divide by 8, with EX0 by 32
+// 5-4  10    MC, continuous count
+// 2    1     TACLR, clear
+// 1    1     TAIE, interrupt on wrap
+}
+
+static void Tach_Edge(uint32_t wheel, uint16_t capture){
+  if(Wraps[wheel] >= 2){
+    Period[wheel] = 0;                // first edge after a stop
+  }else{
+    Period[wheel] = (Wraps[wheel]<<16) + capture - Last[wheel];
+  }
+  Last[wheel] = capture;
+  Wraps[wheel] = 0;
+  Travel += TACH_UM_PER_EDGE;
+  if(Travel >= 2000){
+    Travel -= 2000;                   // 2 mm of one wheel is 1 mm of the center
+    Distance++;
+  }
+}
+
+uint32_t Tach_Speed(uint32_t wheel){
+  uint32_t period = Period[wheel];
+  if((period == 0) || (Wraps[wheel] >= 2)){
+    return 0;
+  }
+  return ((TACH_UM_PER_EDGE*(TACH_HZ/1000))/period);
+}
+
+uint32_t Tach_Distance(void){
+  return Distance;                    // one word, both ISRs run at priority 2
+}
+
+// right encoder
+void TA3_0_IRQHandler(void){
+  TIMER_A3->CCTL[0] &= ~0x0001;       // acknowledge
+  Tach_Edge(TACH_RIGHT, TIMER_A3->CCR[0]);
+}
+
+// left encoder and wraps
+void TA3_N_IRQHandler(void){
+  if(TIMER_A3->CCTL[1]&0x0001){
+    TIMER_A3->CCTL[1] &= ~0x0001;
+    Tach_Edge(TACH_LEFT, TIMER_A3->CCR[1]);
+  }
+  if(TIMER_A3->CTL&0x0001){
+    TIMER_A3->CTL &= ~0x0001;         // TAIFG
+    if(Wraps[TACH_LEFT] < 2) Wraps[TACH_LEFT]++;
+    if(Wraps[TACH_RIGHT] < 2) Wraps[TACH_RIGHT]++;
+  }
+}
@@ -0,0 +1,40 @@
+// Tachometer.h
+// Runs on MSP432
+// Wheel speed and distance from the encoder A channels, timed by
+// TimerA3 input capture on rising edges:
+//   right encoder A  P10.4/TA3CCP0
+//   left encoder A   P10.5/TA3CCP1
+// The B channels (P5.0 right, P5.2 left) are not read, so
+// speeds are magnitudes and distance counts backward as forward.  360 edges per wheel turn, 70 mm wheel.
+// Uses TimerA3 CCR0 and TA3_N interrupts, priority 2.
+
+#ifndef TACHOMETER_H_
+#define TACHOMETER_H_
+#include <stdint.h>
+
+#define TACH_LEFT 0
+#define TACH_RIGHT 1
+
+#define TACH_UM_PER_EDGE 611      // 70 mm wheel * pi / 360 edges
+#define TACH_HZ 375000            // capture clock, SMCLK/32
+
+// ------------Tach_Init------------
+// Start TimerA3 capturing both encoders
+// Input: none
+// Output: none
+void Tach_Init(void);
+
+// ------------Tach_Speed------------
+// Speed of one wheel from its last two edges
+// Input: TACH_LEFT or TACH_RIGHT
+// Output: mm/s, 0 if the wheel has not turned for 350 ms
+uint32_t Tach_Speed(uint32_t wheel);
+
+// ------------Tach_Distance------------
+// Distance driven by the center of the axle, half of the edges
+// of both wheels, so it does not depend on duty or battery
+// Input: none
+// Output: mm since Tach_Init
+uint32_t Tach_Distance(void);
+
+#endif
@@ -0,0 +1,111 @@
+// Trace.c
+// Runs on MSP432
+// Sensor-to-actuation latency tracer.
+// Stamps come from SysTick, TA0_0 and the main loop, so each
+// stamp runs with interrupts off for a few dozen cycles.  The
+// DWT counter wraps every 89 s at 48 MHz; differences across
+// one wrap still come out right in unsigned arithmetic.
+// A handler never preempts itself, so each one owns its entry
+// stamp and counts without a critical section.  A handler that
+// is preempted is charged for the handler that preempted it.
+
+#include <stdint.h>
+#include "msp.h"
+#include "Trace.h"
+#include "..\inc\CortexM.h"
+
+static ROBOT_LOCAL uint32_t Last[TRACE_PWM + 1];    // latest stamp of each stage
+static ROBOT_LOCAL uint32_t Origin[TRACE_PWM + 1];  // TRACE_START stamp of the frame it carries
+static ROBOT_LOCAL uint32_t Pending;                // bit s set if stage s waits for stage s+1
+#pragma NOINIT(Histogram)
+static ROBOT_LOCAL uint32_t Histogram[TRACE_INTERVALS][TRACE_BINS]; // cleared by Trace_Init
+static ROBOT_LOCAL uint32_t Worst[TRACE_INTERVALS]; // us
+ROBOT_LOCAL uint32_t Trace_Entry[TRACE_HANDLERS];
+static ROBOT_LOCAL uint32_t Runs[TRACE_HANDLERS];
+static ROBOT_LOCAL uint64_t Total[TRACE_HANDLERS];  // cycles
+static ROBOT_LOCAL uint32_t Longest[TRACE_HANDLERS];
+
+static void Trace_Record(uint32_t interval, uint32_t cycles){
+  uint32_t us = cycles/TRACE_CYCLES_PER_US;
+  uint32_t bin = 0;
+  if(us > Worst[interval]){
+    Worst[interval] = us;
+  }
+  while(us && (bin < TRACE_BINS - 1)){  // bin = bits in us
+    us = us>>1;
+    bin++;
+  }
+  Histogram[interval][bin]++;
+}
+
+void Trace_Init(void){
+  uint32_t i, b;
+  CoreDebug->DEMCR |= 0x01000000;       // TRCENA, turn on the DWT
+  DWT->CTRL |= 0x00000001;              // CYCCNTENA, count cycles
+  for(i = 0; i < TRACE_INTERVALS; i++){
+    for(b = 0; b < TRACE_BINS; b++){
+      Histogram[i][b] = 0;
+    }
+    Worst[i] = 0;
+  }
+  for(i = 0; i < TRACE_HANDLERS; i++){
+    Runs[i] = 0;
+    Total[i] = 0;
+    Longest[i] = 0;
+  }
+  Pending = 0;
+}
+
+void Trace_Stamp(uint32_t stage){
+  uint32_t now = TRACE_CLOCK();
+  long sr = StartCritical();
+  if(stage == TRACE_START){
+    Origin[TRACE_START] = now;
+    Pending |= 1;
+  }else if(Pending & (1<<(stage - 1))){
+    Trace_Record(stage - 1, now - Last[stage - 1]);
+    Origin[stage] = Origin[stage - 1];
+    Pending &= ~(1<<(stage - 1));
+    if(stage == TRACE_PWM){
+      Trace_Record(TRACE_TOTAL, now - Origin[stage]);
+    }else{
+      Pending |= 1<<stage;
+    }
+  }
+  Last[stage] = now;
+  EndCritical(sr);
+}
+
+const uint32_t *Trace_Histogram(uint32_t interval){
+  return Histogram[interval];
+}
+
+uint32_t Trace_Worst(uint32_t interval){
+  return Worst[interval];
+}
+
+void Trace_Cycles(uint32_t handler){
+  uint32_t cycles = TRACE_CLOCK() - Trace_Entry[handler];
+  Runs[handler]++;
+  Total[handler] += cycles;
+  if(cycles > Longest[handler]){
+    Longest[handler] = cycles;
+  }
+}
+
+uint32_t Trace_Average(uint32_t handler){
+  uint64_t total;
+  uint32_t runs;
+  long sr = StartCritical();        // the handler may be counting now
+  total = Total[handler];
+  runs = Runs[handler];
+  EndCritical(sr);
+  if(runs == 0){
+    return 0;
+  }
+  return total/runs;
+}
+
+uint32_t Trace_Longest(uint32_t handler){
+  return Longest[handler];
+}
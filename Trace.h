@@ -0,0 +1,97 @@
+// Trace.h
+// Runs on MSP432
+// Sensor-to-actuation latency tracer.  Each stage of the
+// pipeline stamps the DWT cycle counter:
+//   TRACE_START     Reflectance_Start charges the sensors
+//   TRACE_END       Reflectance_End captures the frame
+//   TRACE_CLASSIFY  get_next_state first sees the frame
+//   TRACE_CHANGE    the FSM moves to a different state
+//   TRACE_PWM       TA0_0 writes the new duty into CCR3/CCR4
+// Stamping a stage whose previous stage is pending adds the time
+// between them to that interval's histogram, and TRACE_PWM adds
+// the whole START to PWM time to TRACE_TOTAL.  Frames that do not
+// change the state end their trace at TRACE_CLASSIFY.
+// The same build counts the cycles each interrupt handler and
+// task takes, between TRACE_ENTER and TRACE_EXIT, wait states
+// included.
+// Build with LATENCY_TRACE defined; otherwise TRACE_STAMP,
+// TRACE_ENTER and TRACE_EXIT are empty and cost nothing.  The
+// simulator (sim/) builds it in, timed on its own clock.
+
+#ifndef TRACE_H_
+#define TRACE_H_
+#include <stdint.h>
+#include "Robot.h"
+
+#define TRACE_START 0
+#define TRACE_END 1
+#define TRACE_CLASSIFY 2
+#define TRACE_CHANGE 3
+#define TRACE_PWM 4
+
+// histogram i holds the time from stage i to stage i+1
+#define TRACE_CAPTURE 0           // START to END, sensor decay
+#define TRACE_WAIT 1              // END to CLASSIFY, dwell of the current state
+#define TRACE_DECIDE 2            // CLASSIFY to CHANGE
+#define TRACE_ACTUATE 3           // CHANGE to PWM, TimerA1 latch and PWM period
+#define TRACE_TOTAL 4             // START to PWM
+#define TRACE_INTERVALS 5
+
+// handlers timed with TRACE_ENTER/TRACE_EXIT
+#define TRACE_SYSTICK 0           // OS tick, releases the tasks
+#define TRACE_PORT4 1             // bump switches
+#define TRACE_TA0 2               // PWM staged update
+#define TRACE_TA1 3               // actuation latch
+#define TRACE_SENSE 4             // sensing task
+#define TRACE_CONTROL 5           // control task
+#define TRACE_HANDLERS 6
+
+// bin b counts times from 2^(b-1) to 2^b - 1 us, bin 0 is under 1 us,
+// the last bin also takes everything longer
+#define TRACE_BINS 20
+
+// cycle counter and its rate, a host build can supply its own
+#ifndef TRACE_CLOCK
+#define TRACE_CLOCK() (DWT->CYCCNT)
+#endif
+#ifndef TRACE_CYCLES_PER_US
+#define TRACE_CYCLES_PER_US 48
+#endif
+
+#ifdef LATENCY_TRACE
+#define TRACE_STAMP(stage) Trace_Stamp(stage)
+#define TRACE_ENTER(handler) (Trace_Entry[handler] = TRACE_CLOCK())
+#define TRACE_EXIT(handler) Trace_Cycles(handler)
+#else
+#define TRACE_STAMP(stage)
+#define TRACE_ENTER(handler)
+#define TRACE_EXIT(handler)
+#endif
+
+// TRACE_CLOCK when each handler last started
+extern ROBOT_LOCAL uint32_t Trace_Entry[TRACE_HANDLERS];
+
+// Start the DWT cycle counter and empty the histograms
+void Trace_Init(void);
+
+// Record that a stage has happened now
+// Input: TRACE_START to TRACE_PWM
+void Trace_Stamp(uint32_t stage);
+
+// Output: TRACE_BINS counts for one interval
+const uint32_t *Trace_Histogram(uint32_t interval);
+
+// Output: longest time seen for one interval, us
+uint32_t Trace_Worst(uint32_t interval);
+
+// Add the cycles since TRACE_ENTER to a handler's counts
+// Input: TRACE_SYSTICK to TRACE_CONTROL
+void Trace_Cycles(uint32_t handler);
+
+// Output: mean cycles per run of one handler, 0 if it never ran
+uint32_t Trace_Average(uint32_t handler);
+
+// Output: most cycles one run of a handler has taken
+uint32_t Trace_Longest(uint32_t handler);
+
+#endif
@@ -0,0 +1,118 @@
+// Track.c
+// Runs on MSP432
+// Learns the course on the first lap and races it after.
+// A curvature sample combines how hard the robot is steering
+// (Odometry_Steer, -127 to 127) with where the line sits under
+// the array, so a corner still counts while the robot is
+// already centered on it.  The samples in each segment are
+// averaged into one signed byte, 256 bytes cover 12.8 m.
+
+#include <stdint.h>
+#include "Track.h"
+#include "Odometry.h"
+#include "SpeedProfile.h"
+#include "..\inc\Reflectance.h"
+
+#ifdef TRACK_PRELOADED
+#include "TrackProfile.h"         // TRACK_PROFILE_SEGMENTS and TrackProfile[]
+#endif
+
+#define TRACK_EDGE 33400          // um, position of an outer sensor
+
+// close the open segment at index i, and any skipped before it
+static void closeSegment(Track_t *t, uint32_t i){
+  int32_t c = 0;
+  if(t->samples){
+    c = t->sum/t->samples;
+  }
+  if(c > 127) c = 127;
+  if(c < -127) c = -127;
+  while(t->segments <= i){        // fast travel can skip a frame per segment
+    t->curvature[t->segments] = c;
+    t->segments++;
+  }
+  t->sum = 0;
+  t->samples = 0;
+}
+
+void Track_Init(Track_t *t){
+  uint32_t i;
+  t->phase = TRACK_WAIT;
+  t->lapStart = 0;
+  t->segments = 0;
+  t->sum = 0;
+  t->samples = 0;
+#ifdef TRACK_PRELOADED
+  t->segments = TRACK_PROFILE_SEGMENTS;
+  for(i = 0; i < TRACK_PROFILE_SEGMENTS; i++){
+    t->speed[i] = TrackProfile[i];
+  }
+#else
+  for(i = 0; i < PROFILE_MAX_SEGMENTS; i++){
+    t->speed[i] = 0;
+  }
+#endif
+}
+
+void Track_Frame(Track_t *t, uint8_t data, const Odometry_t *o, uint32_t mark){
+  int32_t now = Odometry_Distance(o);
+  int32_t distance = now - t->lapStart;
+  uint32_t i;
+  if(distance < 0){
+    distance = 0;                 // backed up over the bar
+  }
+  if(mark){
+    if(t->phase == TRACK_WAIT){
+#ifdef TRACK_PRELOADED
+      t->phase = TRACK_RACE;
+#else
+      t->phase = TRACK_LEARN;
+      t->segments = 0;
+      t->sum = 0;
+      t->samples = 0;
+#endif
+    }else if(t->phase == TRACK_LEARN){
+      if(t->segments){            // last partial segment is dropped
+        SpeedProfile_Compute(t->curvature, t->segments, t->speed);
+        t->phase = TRACK_RACE;
+      }else{
+        t->phase = TRACK_WAIT;
+      }
+    }
+    t->lapStart = now;
+    return;
+  }
+  if((t->phase != TRACK_LEARN) || (data == 0x00) || (data == 0xFF)){
+    return;                       // lost line and bars say nothing of the curve
+  }
+  i = distance/PROFILE_SEGMENT_MM;
+  if(i >= PROFILE_MAX_SEGMENTS){
+    t->phase = TRACK_WAIT;        // lap too long to learn, stay reactive
+    return;
+  }
+  if(i > t->segments){            // crossed into a new segment
+    closeSegment(t, i - 1);
+  }
+  t->sum += Odometry_Steer(o)/2 + Reflectance_Position(data)*64/TRACK_EDGE;
+  t->samples++;
+}
+
+int16_t Track_Duty(const Track_t *t, int16_t base, int16_t governed, const Odometry_t *o){
+  int32_t distance;
+  uint32_t i;
+  if(t->phase == TRACK_LEARN){
+    return base;
+  }
+  if((t->phase == TRACK_RACE) && t->segments){
+    distance = Odometry_Distance(o) - t->lapStart;
+    if(distance < 0){
+      distance = 0;
+    }
+    i = distance/PROFILE_SEGMENT_MM;
+    if(i >= t->segments){
+      i = t->segments - 1;        // past the learned lap, hold the last speed
+    }
+    return t->speed[i];
+  }
+  return governed;
+}
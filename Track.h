@@ -0,0 +1,50 @@
+// Track.h
+// Runs on MSP432
+// Learns the course on the first lap and races it after.
+// The start/finish bar (see Lap.h) marks the lap.
+// WAIT  before the first bar, drive as usual
+// LEARN first lap, drive at the base duty and record the
+//       curvature of every PROFILE_SEGMENT_MM of travel
+// RACE  later laps, look up the duty for the current distance
+//       in the speed profile built from the learned lap
+
+#ifndef TRACK_H_
+#define TRACK_H_
+#include <stdint.h>
+#include "Odometry.h"
+#include "SpeedProfile.h"
+
+#define TRACK_WAIT 0
+#define TRACK_LEARN 1
+#define TRACK_RACE 2
+
+typedef struct {
+  uint32_t phase;                 // TRACK_WAIT, TRACK_LEARN or TRACK_RACE
+  int32_t lapStart;               // odometry mm at the last lap mark
+  uint32_t segments;              // segments in the learned lap
+  int32_t sum;                    // curvature samples of the open segment
+  int32_t samples;                // number of samples in sum
+  int8_t curvature[PROFILE_MAX_SEGMENTS]; // -127 left to 127 right
+  int16_t speed[PROFILE_MAX_SEGMENTS];    // duty of each segment
+} Track_t;
+
+// Start in TRACK_WAIT.  With TRACK_PRELOADED defined the
+// profile in TrackProfile.h (from tools/lapprofile) is loaded
+// and the robot races from the first bar.
+void Track_Init(Track_t *t);
+
+// Add one frame from the reflectance array
+// Input: data is the 8-bit result from the line sensor
+//        o is the odometry of the robot
+//        mark is 1 on the frame Lap_Frame found the lap marker
+void Track_Frame(Track_t *t, uint8_t data, const Odometry_t *o, uint32_t mark);
+
+// Duty for driving straight
+// Input: base     the conservative duty of the current state
+//        governed the duty the reactive speed governor asks for
+//        o is the odometry of the robot
+// Output: base while learning, the profile while racing,
+//         governed otherwise
+int16_t Track_Duty(const Track_t *t, int16_t base, int16_t governed, const Odometry_t *o);
+
+#endif
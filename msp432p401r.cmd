@@ -40,7 +40,8 @@
 
 MEMORY
 {
-    MAIN       (RX) : origin = 0x00000000, length = 0x00040000
+    MAIN       (RX) : origin = 0x00000000, length = 0x0003F000
+    FLASH_CAL  (R)  : origin = 0x0003F000, length = 0x00001000  /* MotorCal, see Flash.h */
     INFO       (RX) : origin = 0x00200000, length = 0x00004000
 #ifdef  __TI_COMPILER_VERSION__
 #if     __TI_COMPILER_VERSION__ >= 15009000
@@ -97,6 +98,7 @@ SECTIONS
     .vtable :   > 0x20000000
     .data   :   > SRAM_DATA
     .bss    :   > SRAM_DATA
+    .TI.noinit : > SRAM_DATA      /* #pragma NOINIT, not cleared at boot  */
     .sysmem :   > SRAM_DATA
     .stack  :   > SRAM_DATA (HIGH)
 
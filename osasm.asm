@@ -0,0 +1,68 @@
+;/*****************************************************************************/
+; osasm.asm
+; Runs on MSP432
+; Context switch and first thread start for OS.c
+; Threads run on the main stack pointer.  A switched-out thread
+; keeps, from its saved SP up: r4-r11, EXC_RETURN, then the frame
+; the hardware pushed on exception entry.  If the thread had used
+; the FPU, EXC_RETURN bit 4 is 0 and s16-s31 sit above EXC_RETURN,
+; below the extended hardware frame.
+; A RUN_FROM_RAM build runs both from SRAM, with the C handlers.
+
+        .thumb
+  .if $defined(RUN_FROM_RAM)
+        .sect ".TI.ramfunc"
+  .else
+        .text
+  .endif
+        .align 2
+
+        .global  RunPt            ; currently running thread
+        .global  NextPt           ; thread to switch to
+        .global  PendSV_Handler
+        .global  StartOS
+
+RunPtAddr   .field  RunPt,32
+NextPtAddr  .field  NextPt,32
+
+PendSV_Handler:  .asmfunc
+    CPSID   I                     ; no SysTick while the pointers move
+  .if $defined(__TI_VFP_SUPPORT__)
+    TST     LR, #0x10             ; thread used the FPU?
+    IT      EQ
+    VPUSHEQ {S16-S31}             ; callee-saved FPU registers
+  .endif
+    PUSH    {R4-R11, LR}          ; rest of the context, and EXC_RETURN
+    LDR     R0, RunPtAddr         ; R0 = &RunPt
+    LDR     R1, [R0]              ; R1 = RunPt
+    STR     SP, [R1]              ; RunPt->sp = SP
+    LDR     R1, NextPtAddr
+    LDR     R1, [R1]              ; R1 = NextPt
+    STR     R1, [R0]              ; RunPt = NextPt
+    LDR     SP, [R1]              ; SP = NextPt->sp
+    POP     {R4-R11, LR}
+  .if $defined(__TI_VFP_SUPPORT__)
+    TST     LR, #0x10
+    IT      EQ
+    VPOPEQ  {S16-S31}
+  .endif
+    CPSIE   I
+    BX      LR                    ; hardware restores R0-R3, R12, LR, PC, PSR
+    .endasmfunc
+
+StartOS:  .asmfunc
+    LDR     R0, RunPtAddr
+    LDR     R1, [R0]              ; R1 = RunPt
+    LDR     SP, [R1]              ; SP = RunPt->sp
+    POP     {R4-R11}
+    ADD     SP, SP, #4            ; skip EXC_RETURN, the first thread has no FPU frame
+    POP     {R0-R3}
+    POP     {R12}
+    ADD     SP, SP, #4            ; skip LR
+    POP     {LR}                  ; start address
+    ADD     SP, SP, #4            ; skip PSR
+    CPSIE   I
+    BX      LR                    ; run the first thread
+    .endasmfunc
+
+    .end
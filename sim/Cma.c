@@ -0,0 +1,192 @@
+// Cma.c
+// Runs on the host, not the robot
+// CMA-ES with the default strategy parameters of the tutorial.
+// C is decomposed by cyclic Jacobi rotations, often enough that
+// B and D lag C by well under a generation's worth of change.
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "Cma.h"
+
+static double Cma_Uniform(Cma_t *c){
+  c->rng ^= c->rng << 13;
+  c->rng ^= c->rng >> 7;
+  c->rng ^= c->rng << 17;
+  return ((c->rng >> 11) + 0.5)/9007199254740992.0;  // (0,1)
+}
+
+static double Cma_Normal(Cma_t *c){
+  double u = Cma_Uniform(c), v = Cma_Uniform(c);
+  return sqrt(-2*log(u))*cos(6.283185307179586*v);
+}
+
+// B D^2 B' = C, columns of B are the eigenvectors
+static void Cma_Eigen(Cma_t *c){
+  static _Thread_local double A[CMA_MAX_N][CMA_MAX_N];
+  uint32_t n = c->n, i, j, k, sweep;
+  memcpy(A, c->C, sizeof(A));
+  for(i = 0; i < n; i++){
+    for(j = 0; j < n; j++){
+      c->B[i][j] = (i == j);
+    }
+  }
+  for(sweep = 0; sweep < 50; sweep++){
+    double off = 0;
+    for(i = 0; i < n; i++){
+      for(j = i + 1; j < n; j++){
+        off += A[i][j]*A[i][j];
+      }
+    }
+    if(off < 1e-30){
+      break;
+    }
+    for(i = 0; i < n; i++){
+      for(j = i + 1; j < n; j++){
+        double theta, t, cs, sn;
+        if(fabs(A[i][j]) < 1e-300){
+          continue;
+        }
+        theta = (A[j][j] - A[i][i])/(2*A[i][j]);
+        t = ((theta >= 0) ? 1 : -1)/(fabs(theta) + sqrt(theta*theta + 1));
+        cs = 1/sqrt(t*t + 1);
+        sn = t*cs;
+        for(k = 0; k < n; k++){       // A = A J
+          double a = A[k][i], b = A[k][j];
+          A[k][i] = cs*a - sn*b;
+          A[k][j] = sn*a + cs*b;
+        }
+        for(k = 0; k < n; k++){       // A = J' A
+          double a = A[i][k], b = A[j][k];
+          A[i][k] = cs*a - sn*b;
+          A[j][k] = sn*a + cs*b;
+        }
+        for(k = 0; k < n; k++){       // B = B J
+          double a = c->B[k][i], b = c->B[k][j];
+          c->B[k][i] = cs*a - sn*b;
+          c->B[k][j] = sn*a + cs*b;
+        }
+      }
+    }
+  }
+  for(i = 0; i < n; i++){
+    c->D[i] = sqrt((A[i][i] > 1e-20) ? A[i][i] : 1e-20);
+  }
+  c->eigenAt = c->generation;
+}
+
+void Cma_Init(Cma_t *c, uint32_t n, const double *x0, double sigma, uint32_t lambda, uint64_t seed){
+  uint32_t i;
+  double sum = 0, sum2 = 0;
+  memset(c, 0, sizeof(Cma_t));
+  if(n > CMA_MAX_N) n = CMA_MAX_N;
+  if(lambda == 0) lambda = 4 + (uint32_t)(3*log(n));
+  if(lambda > CMA_MAX_LAMBDA) lambda = CMA_MAX_LAMBDA;
+  if(lambda < 2) lambda = 2;
+  c->n = n;
+  c->lambda = lambda;
+  c->mu = lambda/2;
+  for(i = 0; i < c->mu; i++){
+    c->weights[i] = log(c->mu + 0.5) - log(i + 1);
+    sum += c->weights[i];
+  }
+  for(i = 0; i < c->mu; i++){
+    c->weights[i] /= sum;
+    sum2 += c->weights[i]*c->weights[i];
+  }
+  c->mueff = 1/sum2;
+  c->cc = (4 + c->mueff/n)/(n + 4 + 2*c->mueff/n);
+  c->cs = (c->mueff + 2)/(n + c->mueff + 5);
+  c->c1 = 2/((n + 1.3)*(n + 1.3) + c->mueff);
+  c->cmu = 2*(c->mueff - 2 + 1/c->mueff)/((n + 2)*(n + 2) + c->mueff);
+  if(c->cmu > 1 - c->c1) c->cmu = 1 - c->c1;
+  c->damps = 1 + c->cs + 2*((sqrt((c->mueff - 1)/(n + 1)) > 1) ? sqrt((c->mueff - 1)/(n + 1)) - 1 : 0);
+  c->chiN = sqrt(n)*(1 - 1.0/(4*n) + 1.0/(21.0*n*n));
+  c->sigma = sigma;
+  for(i = 0; i < n; i++){
+    c->mean[i] = x0[i];
+    c->C[i][i] = 1;
+    c->B[i][i] = 1;
+    c->D[i] = 1;
+  }
+  c->rng = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+void Cma_Ask(Cma_t *c){
+  double z[CMA_MAX_N];
+  uint32_t k, i, j, n = c->n;
+  for(k = 0; k < c->lambda; k++){
+    for(i = 0; i < n; i++){
+      z[i] = c->D[i]*Cma_Normal(c);
+    }
+    for(i = 0; i < n; i++){
+      double y = 0, x;
+      for(j = 0; j < n; j++){
+        y += c->B[i][j]*z[j];
+      }
+      x = c->mean[i] + c->sigma*y;
+      c->x[k][i] = (x < 0) ? 0 : (x > 1) ? 1 : x;
+    }
+  }
+}
+
+void Cma_Tell(Cma_t *c, const double *cost){
+  uint32_t order[CMA_MAX_LAMBDA];
+  double old[CMA_MAX_N], step[CMA_MAX_N], t[CMA_MAX_N];
+  double norm = 0, hsig;
+  uint32_t k, i, j, n = c->n;
+  for(k = 0; k < c->lambda; k++){     // rank the population, insertion sort
+    for(i = k; (i > 0) && (cost[order[i - 1]] > cost[k]); i--){
+      order[i] = order[i - 1];
+    }
+    order[i] = k;
+  }
+  memcpy(old, c->mean, sizeof(old));
+  for(i = 0; i < n; i++){
+    c->mean[i] = 0;
+    for(k = 0; k < c->mu; k++){
+      c->mean[i] += c->weights[k]*c->x[order[k]][i];
+    }
+    step[i] = (c->mean[i] - old[i])/c->sigma;
+  }
+  // ps from C^-1/2 step = B D^-1 B' step
+  for(j = 0; j < n; j++){
+    t[j] = 0;
+    for(i = 0; i < n; i++){
+      t[j] += c->B[i][j]*step[i];
+    }
+    t[j] /= c->D[j];
+  }
+  for(i = 0; i < n; i++){
+    double s = 0;
+    for(j = 0; j < n; j++){
+      s += c->B[i][j]*t[j];
+    }
+    c->ps[i] = (1 - c->cs)*c->ps[i] + sqrt(c->cs*(2 - c->cs)*c->mueff)*s;
+    norm += c->ps[i]*c->ps[i];
+  }
+  norm = sqrt(norm);
+  hsig = (norm/sqrt(1 - pow(1 - c->cs, 2.0*(c->generation + 1)))/c->chiN) < (1.4 + 2.0/(n + 1));
+  for(i = 0; i < n; i++){
+    c->pc[i] = (1 - c->cc)*c->pc[i] + hsig*sqrt(c->cc*(2 - c->cc)*c->mueff)*step[i];
+  }
+  for(i = 0; i < n; i++){
+    for(j = 0; j <= i; j++){
+      double rankmu = 0;
+      for(k = 0; k < c->mu; k++){
+        const double *x = c->x[order[k]];
+        rankmu += c->weights[k]*((x[i] - old[i])/c->sigma)*((x[j] - old[j])/c->sigma);
+      }
+      c->C[i][j] = (1 - c->c1 - c->cmu)*c->C[i][j]
+                 + c->c1*(c->pc[i]*c->pc[j] + (1 - hsig)*c->cc*(2 - c->cc)*c->C[i][j])
+                 + c->cmu*rankmu;
+      c->C[j][i] = c->C[i][j];
+    }
+  }
+  c->sigma *= exp((c->cs/c->damps)*(norm/c->chiN - 1));
+  if(c->sigma > 1) c->sigma = 1;      // the box is 1 wide
+  c->generation++;
+  if((c->generation - c->eigenAt) >= 1/(10*(c->c1 + c->cmu)*n)){
+    Cma_Eigen(c);
+  }
+}
@@ -0,0 +1,49 @@
+// Cma.h
+// Runs on the host, not the robot
+// CMA-ES, the covariance matrix adaptation evolution strategy
+// (Hansen, "The CMA Evolution Strategy: A Tutorial"), for
+// minimizing a noisy cost over the unit box [0,1]^n.  Samples
+// are clamped into the box and the clamped points drive the
+// update.  The caller asks for a population, costs it, and
+// tells the costs back:
+//   Cma_Init(&cma, n, x0, 0.2, 0, seed);
+//   for(gen...){ Cma_Ask(&cma); cost cma.x[k]...; Cma_Tell(&cma, cost); }
+
+#ifndef CMA_H_
+#define CMA_H_
+#include <stdint.h>
+
+#define CMA_MAX_N 48              // dimensions
+#define CMA_MAX_LAMBDA 64         // population
+
+typedef struct {
+  uint32_t n, lambda, mu;
+  double weights[CMA_MAX_LAMBDA], mueff;
+  double cc, cs, c1, cmu, damps, chiN;
+  double sigma;
+  double mean[CMA_MAX_N];
+  double pc[CMA_MAX_N], ps[CMA_MAX_N];
+  double C[CMA_MAX_N][CMA_MAX_N];
+  double B[CMA_MAX_N][CMA_MAX_N]; // eigenvectors of C, by column
+  double D[CMA_MAX_N];            // square roots of the eigenvalues
+  double x[CMA_MAX_LAMBDA][CMA_MAX_N]; // population of the last Cma_Ask
+  uint32_t generation;
+  uint32_t eigenAt;               // generation of B and D
+  uint64_t rng;
+} Cma_t;
+
+// ------------Cma_Init------------
+// Input: dimensions (at most CMA_MAX_N), start point in [0,1]^n,
+//        step size, population (0 for 4 + 3 ln n), random seed
+void Cma_Init(Cma_t *c, uint32_t n, const double *x0, double sigma, uint32_t lambda, uint64_t seed);
+
+// ------------Cma_Ask------------
+// Sample the next population into c->x[0] to c->x[lambda-1]
+void Cma_Ask(Cma_t *c);
+
+// ------------Cma_Tell------------
+// Update the distribution from the costs of the population
+// Input: cost[k] of c->x[k], lower is better
+void Cma_Tell(Cma_t *c, const double *cost);
+
+#endif
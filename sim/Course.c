@@ -0,0 +1,342 @@
+// Course.c
+// Runs on the host, not the robot
+// Course rasters, course files and the built-in courses.  Each
+// primitive walks the pixels of its bounding box and paints the
+// ones whose centers fall inside it.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Course.h"
+
+#define PI 3.14159265358979323846
+#define COURSE_GATE_MM 100.0      // half length of the built-in lap markers
+#define COURSE_GATE_AHEAD 130.0   // mm from gate 0 to the bar, more than the array
+
+Course_t *Course_New(const char *name, double widthMm, double heightMm, double mmPerPixel){
+  Course_t *c = calloc(1, sizeof(Course_t));
+  if(c == 0){
+    return 0;
+  }
+  strncpy(c->name, name, sizeof(c->name) - 1);
+  c->mmPerPixel = mmPerPixel;
+  c->kind = COURSE_KIND_LINE;
+  c->width = (uint32_t)ceil(widthMm/(c->mmPerPixel*COURSE_TILE))*COURSE_TILE;
+  c->height = (uint32_t)ceil(heightMm/(c->mmPerPixel*COURSE_TILE))*COURSE_TILE;
+  c->tilesX = c->width/COURSE_TILE;
+  c->dark = calloc((size_t)c->width*c->height, 1);
+  if(c->dark == 0){
+    free(c);
+    return 0;
+  }
+  return c;
+}
+
+void Course_Free(Course_t *c){
+  if(c){
+    if(c->map){
+      munmap(c->map, c->mapBytes);
+    }else{
+      free(c->dark);
+    }
+    free(c);
+  }
+}
+
+int Course_Gate(Course_t *c, double x0, double y0, double x1, double y1){
+  if(c->gates == COURSE_GATES){
+    return -1;
+  }
+  c->gate[c->gates][0] = x0;
+  c->gate[c->gates][1] = y0;
+  c->gate[c->gates][2] = x1;
+  c->gate[c->gates][3] = y1;
+  c->gates++;
+  return 0;
+}
+
+// a lap marker across the line at (x,y), for a robot heading h
+static void Course_Across(Course_t *c, double x, double y, double h){
+  double dx = COURSE_GATE_MM*sin(h), dy = COURSE_GATE_MM*cos(h);
+  Course_Gate(c, x + dx, y - dy, x - dx, y + dy);
+}
+
+int Course_Crossed(const double gate[4], double x0, double y0, double x1, double y1){
+  double gx = gate[2] - gate[0], gy = gate[3] - gate[1];
+  double mx = x1 - x0, my = y1 - y0;
+  double s0 = gx*(y0 - gate[1]) - gy*(x0 - gate[0]);   // side of the marker, start
+  double s1 = gx*(y1 - gate[1]) - gy*(x1 - gate[0]);   // and end of the move
+  double t0 = mx*(gate[1] - y0) - my*(gate[0] - x0);   // side of the move, each end
+  double t1 = mx*(gate[3] - y0) - my*(gate[2] - x0);
+  return (s0 > 0) && (s1 <= 0) && (t0*t1 <= 0);
+}
+
+Course_t *Course_Load(const char *path){
+  CourseFile_t h;
+  struct stat st;
+  Course_t *c;
+  void *map;
+  uint32_t g, k;
+  int fd = open(path, O_RDONLY);
+  if(fd < 0){
+    return 0;
+  }
+  if(fstat(fd, &st) || (st.st_size < COURSE_HEADER)){
+    close(fd);
+    errno = EINVAL;
+    return 0;
+  }
+  map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);                      // the mapping keeps the file
+  if(map == MAP_FAILED){
+    return 0;
+  }
+  memcpy(&h, map, sizeof(h));
+  if((h.magic != COURSE_MAGIC) || (h.version != COURSE_VERSION) ||
+     (h.tileShift != COURSE_TILE_SHIFT) || (h.width == 0) || (h.height == 0) ||
+     (h.width%COURSE_TILE) || (h.height%COURSE_TILE) ||
+     ((h.kind != COURSE_KIND_LINE) && (h.kind != COURSE_KIND_MAZE)) ||
+     (h.gates > COURSE_GATES) || !(h.mmPerPixel > 0) ||
+     ((uint64_t)st.st_size != COURSE_HEADER + (uint64_t)h.width*h.height)){
+    munmap(map, st.st_size);
+    errno = EINVAL;
+    return 0;
+  }
+  c = calloc(1, sizeof(Course_t));
+  if(c == 0){
+    munmap(map, st.st_size);
+    return 0;
+  }
+  memcpy(c->name, h.name, sizeof(c->name) - 1);
+  c->width = h.width;
+  c->height = h.height;
+  c->tilesX = h.width/COURSE_TILE;
+  c->mmPerPixel = h.mmPerPixel;
+  c->dark = (uint8_t *)map + COURSE_HEADER;
+  c->startX = h.start[0];
+  c->startY = h.start[1];
+  c->startHeading = h.start[2];
+  c->kind = h.kind;
+  c->gates = h.gates;
+  for(g = 0; g < h.gates; g++){
+    for(k = 0; k < 4; k++){
+      c->gate[g][k] = h.gate[g][k];
+    }
+  }
+  c->map = map;
+  c->mapBytes = st.st_size;
+  return c;
+}
+
+int Course_Save(const Course_t *c, const char *path){
+  static const uint8_t zero[COURSE_HEADER];
+  CourseFile_t h;
+  uint32_t g, k;
+  FILE *out;
+  memset(&h, 0, sizeof(h));
+  h.magic = COURSE_MAGIC;
+  h.version = COURSE_VERSION;
+  h.width = c->width;
+  h.height = c->height;
+  h.tileShift = COURSE_TILE_SHIFT;
+  h.kind = c->kind;
+  h.gates = c->gates;
+  h.mmPerPixel = c->mmPerPixel;
+  h.start[0] = c->startX;
+  h.start[1] = c->startY;
+  h.start[2] = c->startHeading;
+  for(g = 0; g < c->gates; g++){
+    for(k = 0; k < 4; k++){
+      h.gate[g][k] = c->gate[g][k];
+    }
+  }
+  memcpy(h.name, c->name, sizeof(h.name) - 1);
+  out = fopen(path, "wb");
+  if(out == 0){
+    return -1;
+  }
+  if((fwrite(&h, sizeof(h), 1, out) != 1) ||
+     (fwrite(zero, COURSE_HEADER - sizeof(h), 1, out) != 1) ||
+     (fwrite(c->dark, (size_t)c->width*c->height, 1, out) != 1)){
+    fclose(out);
+    return -1;
+  }
+  return fclose(out) ? -1 : 0;
+}
+
+// pixel range covering [lo, hi] mm on an axis of n pixels
+static void Raster_Span(const Course_t *c, double lo, double hi, uint32_t n, uint32_t *first, uint32_t *last){
+  double a = floor(lo/c->mmPerPixel), b = ceil(hi/c->mmPerPixel);
+  if(a < 0) a = 0;
+  if(b > n) b = n;
+  *first = (uint32_t)a;
+  *last = (b > a) ? (uint32_t)b : *first;
+}
+
+// paint a box given by its center, unit axis (ux,uy), half length and half width
+static void Raster_Quad(Course_t *c, double cx, double cy, double ux, double uy, double hl, double hw){
+  double r = hl + hw;
+  uint32_t x0, x1, y0, y1, px, py;
+  Raster_Span(c, cx - r, cx + r, c->width, &x0, &x1);
+  Raster_Span(c, cy - r, cy + r, c->height, &y0, &y1);
+  for(py = y0; py < y1; py++){
+    double dy = (py + 0.5)*c->mmPerPixel - cy;
+    for(px = x0; px < x1; px++){
+      double dx = (px + 0.5)*c->mmPerPixel - cx;
+      if((fabs(dx*ux + dy*uy) <= hl) && (fabs(dy*ux - dx*uy) <= hw)){
+        c->dark[Course_Pixel(c, px, py)] = 255;
+      }
+    }
+  }
+}
+
+void Raster_Line(Course_t *c, double x0, double y0, double x1, double y1, double w){
+  double len = hypot(x1 - x0, y1 - y0);
+  if(len == 0){
+    return;
+  }
+  Raster_Quad(c, (x0 + x1)/2, (y0 + y1)/2, (x1 - x0)/len, (y1 - y0)/len, len/2, w/2);
+}
+
+void Raster_Box(Course_t *c, double cx, double cy, double a, double length, double width){
+  Raster_Quad(c, cx, cy, cos(a), sin(a), length/2, width/2);
+}
+
+void Raster_Arc(Course_t *c, double cx, double cy, double r, double a0, double a1, double w){
+  double outer = r + w/2, inner = r - w/2;
+  uint32_t x0, x1, y0, y1, px, py;
+  Raster_Span(c, cx - outer, cx + outer, c->width, &x0, &x1);
+  Raster_Span(c, cy - outer, cy + outer, c->height, &y0, &y1);
+  for(py = y0; py < y1; py++){
+    double dy = (py + 0.5)*c->mmPerPixel - cy;
+    for(px = x0; px < x1; px++){
+      double dx = (px + 0.5)*c->mmPerPixel - cx;
+      double d = hypot(dx, dy), a;
+      if((d > outer) || (d < inner)){
+        continue;
+      }
+      a = atan2(dy, dx);
+      while(a < a0) a += 2*PI;
+      if(a <= a1){
+        c->dark[Course_Pixel(c, px, py)] = 255;
+      }
+    }
+  }
+}
+
+void Raster_Disc(Course_t *c, double cx, double cy, double r){
+  Raster_Arc(c, cx, cy, r/2, -PI, PI, r);
+}
+
+void Raster_Polygon(Course_t *c, const double *xy, uint32_t n){
+  double lo[2] = {INFINITY, INFINITY}, hi[2] = {-INFINITY, -INFINITY};
+  uint32_t x0, x1, y0, y1, px, py, i, j;
+  if(n < 3){
+    return;
+  }
+  for(i = 0; i < 2*n; i++){
+    if(xy[i] < lo[i&1]) lo[i&1] = xy[i];
+    if(xy[i] > hi[i&1]) hi[i&1] = xy[i];
+  }
+  Raster_Span(c, lo[0], hi[0], c->width, &x0, &x1);
+  Raster_Span(c, lo[1], hi[1], c->height, &y0, &y1);
+  for(py = y0; py < y1; py++){
+    double y = (py + 0.5)*c->mmPerPixel;
+    for(px = x0; px < x1; px++){
+      double x = (px + 0.5)*c->mmPerPixel;
+      int inside = 0;
+      for(i = 0, j = n - 1; i < n; j = i++){
+        const double *a = &xy[2*i], *b = &xy[2*j];
+        if(((a[1] > y) != (b[1] > y)) && (x < a[0] + (b[0] - a[0])*(y - a[1])/(b[1] - a[1]))){
+          inside = !inside;
+        }
+      }
+      if(inside){
+        c->dark[Course_Pixel(c, px, py)] = 255;
+      }
+    }
+  }
+}
+
+// Oval: two 1000 mm straights joined by 300 mm radius half
+// circles, the bar in the middle of the top straight.  Clockwise
+// runs right-hand turns, ccw starts the other way for left ones.
+static Course_t *Course_Oval(const char *name, int ccw){
+  const double s = 500, r = 300, m = 250;
+  Course_t *c = Course_New(name, 2*(s + r + m), 2*(r + m), COURSE_MM_PER_PIXEL);
+  double cx = s + r + m, cy = r + m;
+  if(c == 0){
+    return 0;
+  }
+  Raster_Line(c, cx - s, cy - r, cx + s, cy - r, COURSE_TAPE_MM);
+  Raster_Line(c, cx - s, cy + r, cx + s, cy + r, COURSE_TAPE_MM);
+  Raster_Arc(c, cx + s, cy, r, -PI/2, PI/2, COURSE_TAPE_MM);
+  Raster_Arc(c, cx - s, cy, r, PI/2, 3*PI/2, COURSE_TAPE_MM);
+  Raster_Box(c, cx, cy - r, 0, COURSE_BAR_MM, COURSE_BAR_WIDTH_MM);
+  c->startX = ccw ? cx + 350 : cx - 350;
+  c->startY = cy - r;
+  c->startHeading = ccw ? PI : 0;
+  Course_Across(c, ccw ? cx + COURSE_GATE_AHEAD : cx - COURSE_GATE_AHEAD, cy - r, c->startHeading);
+  return c;
+}
+
+// Rectangle: 1400 by 900 mm with 150 mm radius corners, clockwise
+static Course_t *Course_Rect(const char *name){
+  const double hx = 700, hy = 450, r = 150, m = 250;
+  Course_t *c = Course_New(name, 2*(hx + m), 2*(hy + m), COURSE_MM_PER_PIXEL);
+  double cx = hx + m, cy = hy + m;
+  if(c == 0){
+    return 0;
+  }
+  Raster_Line(c, cx - hx + r, cy - hy, cx + hx - r, cy - hy, COURSE_TAPE_MM);
+  Raster_Line(c, cx - hx + r, cy + hy, cx + hx - r, cy + hy, COURSE_TAPE_MM);
+  Raster_Line(c, cx - hx, cy - hy + r, cx - hx, cy + hy - r, COURSE_TAPE_MM);
+  Raster_Line(c, cx + hx, cy - hy + r, cx + hx, cy + hy - r, COURSE_TAPE_MM);
+  Raster_Arc(c, cx + hx - r, cy - hy + r, r, -PI/2, 0, COURSE_TAPE_MM);
+  Raster_Arc(c, cx + hx - r, cy + hy - r, r, 0, PI/2, COURSE_TAPE_MM);
+  Raster_Arc(c, cx - hx + r, cy + hy - r, r, PI/2, PI, COURSE_TAPE_MM);
+  Raster_Arc(c, cx - hx + r, cy - hy + r, r, PI, 3*PI/2, COURSE_TAPE_MM);
+  Raster_Box(c, cx, cy - hy, 0, COURSE_BAR_MM, COURSE_BAR_WIDTH_MM);
+  c->startX = cx - 350;
+  c->startY = cy - hy;
+  c->startHeading = 0;
+  Course_Across(c, cx - COURSE_GATE_AHEAD, cy - hy, 0);
+  return c;
+}
+
+const char *Course_Names(void){
+  return "oval ovalccw rect";
+}
+
+Course_t *Course_Make(const char *name){
+  if(strcmp(name, "oval") == 0){
+    return Course_Oval(name, 0);
+  }
+  if(strcmp(name, "ovalccw") == 0){
+    return Course_Oval(name, 1);
+  }
+  if(strcmp(name, "rect") == 0){
+    return Course_Rect(name);
+  }
+  return 0;
+}
+
+Course_t *Course_Open(const char *name){
+  Course_t *c = Course_Make(name);
+  if(c){
+    return c;
+  }
+  c = Course_Load(name);
+  if(c == 0){
+    fprintf(stderr, "%s: %s, and not a built-in course (%s)\n", name,
+            (errno == EINVAL) ? "not a course file" : strerror(errno), Course_Names());
+  }
+  return c;
+}
@@ -0,0 +1,183 @@
+// Course.h
+// Runs on the host, not the robot
+// A course is a raster of how dark the floor is, 0 white to 255
+// black, at COURSE_MM_PER_PIXEL, plus where the robot starts.
+// The image frame has x to the right and y down, so a heading
+// that increases turns the robot clockwise, to its right.
+// Courses are drawn from line segments and arcs of tape, or
+// loaded from a course file, and one copy is shared read-only by
+// every run on it.
+// The raster is stored in COURSE_TILE square tiles, each tile's
+// rows together, so the few pixels around the sensor array are
+// in a handful of cache lines whatever the heading.
+// A course file is a CourseFile_t header, padded to
+// COURSE_HEADER bytes, followed by the raster exactly as it is
+// held in memory.  Course_Load maps it read-only and shared, so
+// the raster is never copied and every process running the
+// course, farm and tune alike, reads the same pages of the page
+// cache.  Files are in the byte order of the host that wrote
+// them; mkcourse writes them from SVG, PNG or PGM drawings.
+// Lap markers are lines across the tape that the simulator
+// watches the axle cross, so it knows the laps really driven
+// whatever the firmware counts.  Gate 0 starts and ends a lap,
+// the others must be crossed in order in between.  Each counts
+// when crossed with its first end on the robot's left.  Put gate
+// 0 before the bar, where the axle crosses it before the array
+// reaches the bar.
+
+#ifndef COURSE_H_
+#define COURSE_H_
+#include <stdint.h>
+#include <stddef.h>
+
+#define COURSE_MM_PER_PIXEL 1.0
+#define COURSE_TILE_SHIFT 4
+#define COURSE_TILE (1 << COURSE_TILE_SHIFT) // pixels on a side, 256 bytes
+#define COURSE_TAPE_MM 19.0       // electrical tape
+#define COURSE_BAR_MM 60.0        // start/finish bar, along the line
+#define COURSE_BAR_WIDTH_MM 150.0 // across the line, wider than the array
+#define COURSE_GATES 4            // lap markers a course can have
+
+// kind, the COURSE build of LineFollowFSMmain.c that runs it
+#define COURSE_KIND_LINE 0        // closed loop with a start/finish bar, COURSE_LINE
+#define COURSE_KIND_MAZE 1        // grid maze with a goal pad, COURSE_MAZE
+
+#define COURSE_MAGIC 0x4B525452   // "RTRK" in a little-endian file
+#define COURSE_VERSION 1
+#define COURSE_HEADER 4096        // bytes before the raster, a page
+
+typedef struct {
+  char name[32];
+  uint32_t width, height;         // pixels, multiples of COURSE_TILE
+  uint32_t tilesX;                // tiles per row of tiles
+  double mmPerPixel;
+  uint8_t *dark;                  // width*height, by tile, see Course_Pixel
+  double startX, startY;          // mm, the axle center
+  double startHeading;            // rad, 0 along +x
+  uint32_t kind;                  // COURSE_KIND_LINE or COURSE_KIND_MAZE
+  uint32_t gates;                 // lap markers in gate[], 0 for none
+  double gate[COURSE_GATES][4];   // mm, x0 y0 x1 y1, see above
+  void *map;                      // the file mapping, 0 if dark was allocated
+  size_t mapBytes;
+} Course_t;
+
+// the header of a course file
+typedef struct {
+  uint32_t magic;                 // COURSE_MAGIC
+  uint32_t version;               // COURSE_VERSION
+  uint32_t width, height;         // pixels, multiples of COURSE_TILE
+  uint32_t tileShift;             // COURSE_TILE_SHIFT
+  uint32_t kind;
+  uint32_t gates;
+  float mmPerPixel;
+  float start[3];                 // mm, mm, rad
+  float gate[COURSE_GATES][4];    // mm
+  char name[32];
+} CourseFile_t;
+
+// ------------Course_Make------------
+// Draw one of the built-in courses
+// Input: name, see Course_Names
+// Output: the course, 0 if the name is unknown or out of memory
+Course_t *Course_Make(const char *name);
+
+// ------------Course_Names------------
+// Output: the built-in course names, separated by spaces
+const char *Course_Names(void);
+
+// ------------Course_Load------------
+// Map a course file
+// Input: path
+// Output: the course, 0 with errno set if the file cannot be
+//         read, EINVAL if it is not a course file of this host,
+//         has no pixels or is of an unknown kind.  Whether the
+//         kind suits the firmware is up to the caller, farm and
+//         tune check it
+Course_t *Course_Load(const char *path);
+
+// ------------Course_Save------------
+// Write a course file
+// Input: the course, path
+// Output: 0 on success, -1 with errno set
+int Course_Save(const Course_t *c, const char *path);
+
+// ------------Course_Open------------
+// A built-in course by name, or else a course file
+// Input: name or path
+// Output: the course, 0 after saying why on stderr
+Course_t *Course_Open(const char *name);
+
+// ------------Course_Free------------
+void Course_Free(Course_t *c);
+
+// ------------Course_Pixel------------
+// Input: pixel column and row, inside the raster
+// Output: index of the pixel in dark[]
+static inline uint32_t Course_Pixel(const Course_t *c, uint32_t px, uint32_t py){
+  return ((((py >> COURSE_TILE_SHIFT)*c->tilesX + (px >> COURSE_TILE_SHIFT)) << (2*COURSE_TILE_SHIFT))
+         | ((py&(COURSE_TILE - 1)) << COURSE_TILE_SHIFT) | (px&(COURSE_TILE - 1)));
+}
+
+// ------------Course_Dark------------
+// Darkness of the floor under a point, nearest pixel
+// Input: mm
+// Output: 0 to 255, 0 off the raster
+static inline uint8_t Course_Dark(const Course_t *c, double x, double y){
+  int32_t px = (int32_t)(x/c->mmPerPixel);
+  int32_t py = (int32_t)(y/c->mmPerPixel);
+  if((x < 0) || (y < 0) || ((uint32_t)px >= c->width) || ((uint32_t)py >= c->height)){
+    return 0;
+  }
+  return c->dark[Course_Pixel(c, px, py)];
+}
+
+// ------------Course_Inside------------
+// Output: 1 if the point is on the raster
+static inline int Course_Inside(const Course_t *c, double x, double y){
+  return (x >= 0) && (y >= 0) &&
+         (x < c->width*c->mmPerPixel) && (y < c->height*c->mmPerPixel);
+}
+
+// Drawing, all in mm.  Each paints max(dark) into the pixels
+// whose centers it covers.
+// ------------Raster_Line------------
+// Tape from (x0,y0) to (x1,y1), w wide, square ends
+void Raster_Line(Course_t *c, double x0, double y0, double x1, double y1, double w);
+
+// ------------Raster_Arc------------
+// Tape along the circle of radius r about (cx,cy), w wide, from
+// angle a0 clockwise to a1 (rad, image frame, a1 > a0)
+void Raster_Arc(Course_t *c, double cx, double cy, double r, double a0, double a1, double w);
+
+// ------------Raster_Box------------
+// Rectangle centered at (cx,cy), length along heading a, width across
+void Raster_Box(Course_t *c, double cx, double cy, double a, double length, double width);
+
+// ------------Raster_Disc------------
+// Disc of radius r about (cx,cy)
+void Raster_Disc(Course_t *c, double cx, double cy, double r);
+
+// ------------Raster_Polygon------------
+// Inside of a closed polygon, even-odd
+// Input: n points, x and y of each in turn
+void Raster_Polygon(Course_t *c, const double *xy, uint32_t n);
+
+// ------------Course_New------------
+// Blank white course, a line course with no lap markers
+// Input: name, size in mm, scale
+// Output: the course, 0 if out of memory
+Course_t *Course_New(const char *name, double widthMm, double heightMm, double mmPerPixel);
+
+// ------------Course_Gate------------
+// Add a lap marker
+// Input: mm, from the end on the robot's left to the one on its right
+// Output: 0, -1 if the course has COURSE_GATES already
+int Course_Gate(Course_t *c, double x0, double y0, double x1, double y1);
+
+// ------------Course_Crossed------------
+// Whether a move crosses a lap marker the right way
+// Input: the marker, the move from (x0,y0) to (x1,y1), mm
+// Output: 1 if it crosses with the marker's first end on its left
+int Course_Crossed(const double gate[4], double x0, double y0, double x1, double y1);
+
+#endif
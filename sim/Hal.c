@@ -0,0 +1,326 @@
+// Hal.c
+// Runs on the host, not the robot
+// Stand-ins for the drivers and the kernel the firmware calls.
+// Each acts on the run of its own thread, Sim.  Motor commands
+// move the World_t wheels, reflectance reads sample the course,
+// and the rest is idle: the battery is always at nominal, the
+// flash holds no motor table, nothing bumps but the tap of Sim.c
+// and nothing misses a deadline.  The latency tracer is stamped
+// where the drivers stamp it: reflectance start and end, and the
+// latch putting a new duty on the wheels.
+
+#include <stdint.h>
+#include <string.h>
+#include "Sim.h"
+#include "Motor.h"
+#include "Actuate.h"
+#include "OS.h"
+#include "Deadline.h"
+#include "Boot.h"
+#include "Battery.h"
+#include "MotorCal.h"
+#include "Tachometer.h"
+#include "RamFunc.h"
+#include "BumpInt.h"
+#include "Odometry.h"
+#include "Flash.h"
+#include "Trace.h"
+#include "../inc/Clock.h"
+#include "../inc/CortexM.h"
+#include "../inc/Reflectance.h"
+#include "../inc/UART0.h"
+
+_Thread_local Sim_t *Sim;
+_Thread_local Boot_t Boot;
+_Thread_local Deadline_t Deadline;
+DIO_PORT_Type Sim_P4;
+_Thread_local DWT_Type Sim_DWT;
+_Thread_local CoreDebug_Type Sim_CoreDebug;
+
+void Hal_Reset(void){
+  memset(&Boot, 0, sizeof(Boot));
+  memset(&Deadline, 0, sizeof(Deadline));
+  Flash_Erase();
+}
+
+int32_t Sim_Tune(int32_t state, int32_t field, int32_t value){
+  const Param_t *p = Sim->job->param;
+  Param_t *b = Sim->job->built;
+  if((uint32_t)state >= PARAM_STATES){
+    return value;
+  }
+  if(b){
+    b->tune[state][field] = value;
+    b->set[state][field] = 1;
+  }
+  if(p && p->set[state][field]){
+    return p->tune[state][field];
+  }
+  return value;
+}
+
+int32_t Sim_Param(int32_t id, int32_t value){
+  const Param_t *p = Sim->job->param;
+  Param_t *b = Sim->job->built;
+  if((uint32_t)id >= ROBOT_PARAMS){
+    return value;
+  }
+  if(b){
+    b->param[id] = value;
+    b->paramSet[id] = 1;
+  }
+  if(p && p->paramSet[id]){
+    return p->param[id];
+  }
+  return value;
+}
+
+uint32_t Sim_Clock(void){
+  return Sim->ms*1000*TRACE_CYCLES_PER_US;
+}
+
+// kernel: OS_Launch runs the whole simulation and returns at its end,
+// the background task is never run
+void OS_Init(void){
+  Sim->tasks = 0;
+}
+
+uint32_t OS_AddTask(void(*task)(void), uint32_t period){
+  if(Sim->tasks == OS_TASKS){
+    return OS_TASKS;
+  }
+  Sim->task[Sim->tasks] = task;
+  Sim->period[Sim->tasks] = period;
+  return Sim->tasks++;
+}
+
+void OS_Launch(uint32_t tick){
+  (void)tick;
+  Sim_Loop();
+}
+
+uint32_t OS_Misses(uint32_t id){
+  (void)id;
+  return 0;
+}
+
+// motors, in mm/s at ODOMETRY_FULL_SPEED for MOTOR_DUTY_FULL
+static double Hal_Speed(int32_t duty){
+  if(duty > MOTOR_DUTY_FULL) duty = MOTOR_DUTY_FULL;
+  if(duty < -MOTOR_DUTY_FULL) duty = -MOTOR_DUTY_FULL;
+  return (double)duty*ODOMETRY_FULL_SPEED/MOTOR_DUTY_FULL;
+}
+
+void Motor_Init(void){
+  World_Drive(&Sim->world, 0, 0);
+}
+
+void Motor_Drive(int16_t leftDuty, int16_t rightDuty){
+  World_Drive(&Sim->world, Hal_Speed(leftDuty), Hal_Speed(rightDuty));
+  if(leftDuty || rightDuty){
+    Sim->moved = 1;
+  }
+}
+
+void Motor_Speed(int16_t leftSpeed, int16_t rightSpeed){
+  Motor_Drive(MotorCal_Duty(TACH_LEFT, leftSpeed), MotorCal_Duty(TACH_RIGHT, rightSpeed));
+}
+
+void Motor_Supply(uint32_t mV){
+  (void)mV;
+}
+
+void Motor_Stop(void){ Motor_Drive(0, 0); }
+void Motor_Brake(void){ Motor_Drive(0, 0); }
+void Motor_Halt(void){ Motor_Drive(0, 0); }
+void Motor_Coast(void){ Motor_Drive(0, 0); }
+void Motor_Sleep(void){ Motor_Drive(0, 0); }
+void Motor_Forward(uint16_t leftDuty, uint16_t rightDuty){ Motor_Drive(leftDuty, rightDuty); }
+void Motor_ForwardNow(uint16_t leftDuty, uint16_t rightDuty){ Motor_Drive(leftDuty, rightDuty); }
+void Motor_Right(uint16_t leftDuty, uint16_t rightDuty){ Motor_Drive(leftDuty, -rightDuty); }
+void Motor_Left(uint16_t leftDuty, uint16_t rightDuty){ Motor_Drive(-leftDuty, rightDuty); }
+void Motor_Backward(uint16_t leftDuty, uint16_t rightDuty){ Motor_Drive(-leftDuty, -rightDuty); }
+
+// flash, the calibration sector as an array
+ROBOT_LOCAL uint32_t Flash_Cal[FLASH_CAL_WORDS];
+
+uint32_t Flash_Erase(void){
+  memset(Flash_Cal, 0xFF, sizeof(Flash_Cal));
+  return 0;
+}
+
+uint32_t Flash_Write(const uint32_t *source, uint32_t count){
+  if(count > FLASH_CAL_WORDS){
+    return 1;
+  }
+  memcpy(Flash_Cal, source, count*4);
+  return 0;
+}
+
+// encoders, the wheels of World_t as they turn
+void Tach_Init(void){
+}
+
+uint32_t Tach_Speed(uint32_t wheel){
+  double v = (wheel == TACH_LEFT) ? Sim->world.left : Sim->world.right;
+  return (uint32_t)((v < 0) ? -v : v);
+}
+
+// the axle center, half of both wheels, as the edge count gives it
+uint32_t Tach_Distance(void){
+  return (uint32_t)(Sim->world.travel/2);
+}
+
+// actuation latch, every tick
+void Actuate_Init(void){
+  Sim->posted = 0;
+}
+
+void Actuate_Command(int16_t leftDuty, int16_t rightDuty, uint8_t mode){
+  Sim->postLeft = leftDuty;
+  Sim->postRight = rightDuty;
+  Sim->postMode = mode;
+  Sim->posted = 1;
+}
+
+void Actuate_Halt(void){
+  Sim->posted = 0;
+  Motor_Brake();
+}
+
+void Hal_Latch(void){
+  if(Sim->posted == 0){
+    return;
+  }
+  Sim->posted = 0;
+  if(Sim->postMode == ACTUATE_STOP){
+    Motor_Stop();
+    Sim->stopped = Sim->moved;
+  }else if(Sim->postMode == ACTUATE_SPEED){
+    Motor_Speed(Sim->postLeft, Sim->postRight);
+  }else{
+    Motor_Drive(Sim->postLeft, Sim->postRight);
+  }
+  TRACE_STAMP(TRACE_PWM);
+}
+
+// reflectance, read 1 ms after the start like the real sensors
+static const int32_t weight[8] = {-33400,-23800,-14300,-4800,4800,14300,23800,33400};
+
+void Reflectance_Init(void){
+}
+
+void Reflectance_Start(void){
+  TRACE_STAMP(TRACE_START);
+}
+
+uint8_t Reflectance_End(void){
+  uint8_t data = World_Sense(&Sim->world);
+  TRACE_STAMP(TRACE_END);
+  Sim->result->frames++;
+  if(data){
+    Sim->lineMs = Sim->ms;
+  }else{
+    Sim->result->lostFrames++;
+  }
+  return data;
+}
+
+uint8_t Reflectance_Read(uint32_t time){
+  World_Sense(&Sim->world);
+  return Sensor_Bits(Sim->world.decay, time + 10); // after the 10 us charge
+}
+
+uint8_t Reflectance_Center(uint32_t time){
+  uint8_t data = Reflectance_Read(time);
+  return ((data&0x10) ? 2 : 0) | ((data&0x08) ? 1 : 0);
+}
+
+int32_t Reflectance_Position(uint8_t data){
+  int32_t sum = 0, weightedSum = 0, i;
+  for(i = 0; i < 8; i++){
+    if(data&(0x80 >> i)){
+      sum++;
+      weightedSum += weight[i];
+    }
+  }
+  if(sum == 0){
+    return 0;
+  }
+  return weightedSum/sum;
+}
+
+// bump switches, pressed only by the tap that starts a maze fast run
+void BumpInt_Init(void){
+}
+
+uint8_t Bump_Read(void){
+  return Sim->bump;
+}
+
+// battery at nominal
+void Battery_Init(void){
+}
+
+uint32_t Battery_Tick(void){
+  return 0;
+}
+
+uint32_t Battery_Millivolts(void){
+  return BATTERY_NOMINAL_MV;
+}
+
+uint32_t Battery_State(void){
+  return BATTERY_OK;
+}
+
+uint32_t Battery_Limit(void){
+  return MOTOR_DUTY_FULL;
+}
+
+// boot record, deadline, RAM functions
+void Boot_Mark(uint32_t phase){
+  if(phase == Boot.phase){
+    Boot.phase++;
+  }
+}
+
+void Boot_Clock(uint32_t mhz){
+  Boot.mhz = mhz;
+}
+
+uint32_t Boot_Total(void){
+  return 0;
+}
+
+void Deadline_Init(void){
+}
+
+void Deadline_CheckIn(void){
+  Deadline.checkins++;
+}
+
+void Deadline_Stage(uint32_t stage){
+  Deadline.stage = stage;
+}
+
+void RamFunc_Init(void){
+}
+
+// clock, CPU and UART, nothing to do
+void Clock_Init48MHz(void){}
+uint32_t Clock_GetFreq(void){ return 48000000; }
+void Clock_Delay1us(uint32_t n){ (void)n; }
+void Clock_Delay1ms(uint32_t n){ (void)n; }
+void DisableInterrupts(void){}
+void EnableInterrupts(void){}
+long StartCritical(void){ return 0; }
+void EndCritical(long sr){ (void)sr; }
+void WaitForInterrupt(void){}
+void UART0_Init(void){}
+char UART0_InChar(void){ return 0; }
+void UART0_OutChar(char data){ (void)data; }
+void UART0_OutString(char *pt){ (void)pt; }
+void UART0_OutUDec(uint32_t n){ (void)n; }
+void UART0_OutSDec(int32_t n){ (void)n; }
+void UART0_OutUHex(uint32_t number){ (void)number; }
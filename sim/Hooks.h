@@ -0,0 +1,36 @@
+// Hooks.h
+// Runs on the host, not the robot
+// Forced in front of every file of the simulator, firmware
+// included, by the Makefile (-include Hooks.h).  See Robot.h.
+// Each worker thread has its own copy of the firmware's globals
+// and runs one robot at a time.
+
+#ifndef HOOKS_H_
+#define HOOKS_H_
+#include <stdint.h>
+
+#define ROBOT_LOCAL _Thread_local
+#define ROBOT_TUNE(state, field, value) Sim_Tune(state, field, value)
+#define ROBOT_PARAM(id, value) Sim_Param(id, value)
+#define LATENCY_TRACE
+#define TRACE_CLOCK() Sim_Clock()
+
+// ------------Sim_Tune------------
+// Value of a state field in the parameter set of this run
+// Input: index into fsm[], ROBOT_LEFT to ROBOT_DELAY, table value
+// Output: the set's value if it has one, else the table value
+int32_t Sim_Tune(int32_t state, int32_t field, int32_t value);
+
+// ------------Sim_Param------------
+// Value of a controller constant in the parameter set of this run
+// Input: ROBOT_SLIGHT_BAND to ROBOT_PROFILE_SLOW, the #define
+// Output: the set's value if it has one, else the #define
+int32_t Sim_Param(int32_t id, int32_t value);
+
+// ------------Sim_Clock------------
+// The cycle counter of the latency tracer, Trace.h
+// Output: simulated time in cycles at TRACE_CYCLES_PER_US,
+//         in steps of a tick, the tasks of a tick take no time
+uint32_t Sim_Clock(void);
+
+#endif
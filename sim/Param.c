@@ -0,0 +1,177 @@
+// Param.c
+// Runs on the host, not the robot
+// Parameter sets and the text form of them.
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Param.h"
+
+// in fsm[] order, see the #defines in LineFollowFSMmain.c
+static const char * const StateName[PARAM_STATES] = {
+  "Center", "SlightLeft", "Left", "SlightRight", "Right",
+  "BufferCenter", "BufferCenter2", "LostRight", "LostRight2", "OffCenter",
+  "OffLeft", "OffLeft2", "OffLeft3", "OffRight", "OffRight2", "OffRight3",
+  "Stop", "InitCenter", "Brake", "Reverse",
+  "LostRight3", "LostRight4", "LostRight5", "LostRight6",
+  "LostLeft", "LostLeft2", "LostLeft3", "LostLeft4", "LostLeft5", "LostLeft6",
+  "MazeCreepLeft", "MazeCreepRight", "MazeLeft", "MazeLeft2",
+  "MazeRight", "MazeRight2", "MazeBack", "GapHold"
+};
+
+static const char * const FieldName[PARAM_FIELDS] = {"left", "right", "delay"};
+
+// in ROBOT_PARAM id order, see Robot.h
+static const char * const ParamName[ROBOT_PARAMS] = {
+  "SLIGHT_BAND", "STRONG_BAND", "GAP_MM", "ESTIMATOR_ALPHA",
+  "ESTIMATOR_BETA", "GOVERNOR_MAX_DUTY", "PROFILE_FAST", "PROFILE_SLOW"
+};
+
+static const struct { const char *key; size_t offset; } World[] = {
+  {"mismatch", offsetof(WorldConfig_t, mismatch)},
+  {"glitch", offsetof(WorldConfig_t, glitch)},
+  {"jitter", offsetof(WorldConfig_t, jitter)},
+  {"yaw", offsetof(WorldConfig_t, yaw)},
+  {"lag", offsetof(WorldConfig_t, lag)},
+  {"array", offsetof(WorldConfig_t, array)},
+  {"sensor", offsetof(WorldConfig_t, sensor)},
+  {"wheelbase", offsetof(WorldConfig_t, wheelbase)},
+};
+#define WORLD_KEYS (sizeof(World)/sizeof(World[0]))
+
+void Param_Default(Param_t *p, const char *name){
+  memset(p, 0, sizeof(Param_t));
+  snprintf(p->name, PARAM_NAME, "%s", name);
+  p->world.mismatch = 0.03;
+  p->world.glitch = 0.001;
+  p->world.jitter = 5;
+  p->world.yaw = 3;
+  p->world.lag = 40;
+  p->world.array = 70;
+  p->world.sensor = 0.1;
+  p->world.wheelbase = 140;
+}
+
+int32_t Param_State(const char *name){
+  int32_t i;
+  for(i = 0; i < PARAM_STATES; i++){
+    if(strcmp(name, StateName[i]) == 0){
+      return i;
+    }
+  }
+  return -1;
+}
+
+const char *Param_StateName(uint32_t i){
+  return (i < PARAM_STATES) ? StateName[i] : "?";
+}
+
+const char *Param_FieldName(uint32_t field){
+  return (field < PARAM_FIELDS) ? FieldName[field] : "?";
+}
+
+const char *Param_ParamName(uint32_t id){
+  return (id < ROBOT_PARAMS) ? ParamName[id] : "?";
+}
+
+int Param_Set(Param_t *p, const char *key, const char *value){
+  char state[PARAM_NAME];
+  const char *dot = strchr(key, '.');
+  char *end;
+  double v = strtod(value, &end);
+  int32_t s, f;
+  uint32_t i;
+  if((end == value) || (*end != '\0')){
+    return -1;
+  }
+  if(dot == 0){
+    for(i = 0; i < WORLD_KEYS; i++){
+      if(strcmp(key, World[i].key) == 0){
+        *(double *)((char *)&p->world + World[i].offset) = v;
+        return 0;
+      }
+    }
+    for(i = 0; i < ROBOT_PARAMS; i++){
+      if(strcmp(key, ParamName[i]) == 0){
+        p->param[i] = (int32_t)v;
+        p->paramSet[i] = 1;
+        return 0;
+      }
+    }
+    return -1;
+  }
+  if((size_t)(dot - key) >= sizeof(state)){
+    return -1;
+  }
+  memcpy(state, key, dot - key);
+  state[dot - key] = '\0';
+  s = Param_State(state);
+  for(f = 0; f < PARAM_FIELDS; f++){
+    if(strcmp(dot + 1, FieldName[f]) == 0){
+      break;
+    }
+  }
+  if((s < 0) || (f == PARAM_FIELDS)){
+    return -1;
+  }
+  p->tune[s][f] = (int32_t)v;
+  p->set[s][f] = 1;
+  return 0;
+}
+
+int Param_Parse(Param_t *p, char *line){
+  char *hash = strchr(line, '#');
+  char *tok, *eq;
+  if(hash){
+    *hash = '\0';
+  }
+  tok = strtok(line, " \t\r\n");
+  if(tok == 0){
+    return 1;
+  }
+  Param_Default(p, tok);
+  while((tok = strtok(0, " \t\r\n")) != 0){
+    eq = strchr(tok, '=');
+    if(eq == 0){
+      snprintf(p->name, PARAM_NAME, "%s", tok);
+      return -1;
+    }
+    *eq = '\0';
+    if(Param_Set(p, tok, eq + 1)){
+      snprintf(p->name, PARAM_NAME, "%s", tok);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int Param_Write(const Param_t *p, char *line, size_t size){
+  Param_t d;
+  size_t n;
+  uint32_t i, s, f;
+  Param_Default(&d, p->name);
+  n = snprintf(line, size, "%s", p->name);
+#define PARAM_OUT(...) n += snprintf(line + ((n < size) ? n : size), (n < size) ? size - n : 0, __VA_ARGS__)
+  for(i = 0; i < WORLD_KEYS; i++){
+    double v = *(const double *)((const char *)&p->world + World[i].offset);
+    if(v != *(const double *)((const char *)&d.world + World[i].offset)){
+      PARAM_OUT(" %s=%g", World[i].key, v);
+    }
+  }
+  for(i = 0; i < ROBOT_PARAMS; i++){
+    if(p->paramSet[i]){
+      PARAM_OUT(" %s=%d", ParamName[i], (int)p->param[i]);
+    }
+  }
+  for(s = 0; s < PARAM_STATES; s++){
+    for(f = 0; f < PARAM_FIELDS; f++){
+      if(p->set[s][f]){
+        PARAM_OUT(" %s.%s=%d", StateName[s], FieldName[f], (int)p->tune[s][f]);
+      }
+    }
+  }
+#undef PARAM_OUT
+  return (int)n;
+}
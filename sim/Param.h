@@ -0,0 +1,83 @@
+// Param.h
+// Runs on the host, not the robot
+// A parameter set: the world a run is simulated in and the FSM
+// state outputs and dwells that replace those in fsm[].  One set
+// per line of text,
+//   name key=value key=value ...
+// keys are the WorldConfig_t fields below, State.field with a
+// state named as in the fsm[] comments (Center, SlightLeft, ...,
+// GapHold) and field left, right or delay, or a controller
+// constant by the name of its #define (see ROBOT_PARAM), e.g.
+//   fast Center.left=7500 Center.right=7500 SLIGHT_BAND=2500 glitch=0.002
+// Anything after # is a comment.
+
+#ifndef PARAM_H_
+#define PARAM_H_
+#include <stddef.h>
+#include <stdint.h>
+#include "Robot.h"
+
+#define PARAM_STATES 38           // entries of fsm[]
+#define PARAM_FIELDS 3            // ROBOT_LEFT to ROBOT_DELAY
+#define PARAM_NAME 32
+
+typedef struct {
+  double mismatch;                // wheel speed error, each wheel of a run within +-, fraction
+  double glitch;                  // chance a sensor bit reads wrong in a frame
+  double jitter;                  // mm, start across the line within +-
+  double yaw;                     // deg, start heading within +-
+  double lag;                     // ms, motor time constant
+  double array;                   // mm, sensor array ahead of the axle
+  double sensor;                  // decay time error, each sensor of a run within +-, fraction
+  double wheelbase;               // mm, between the wheels
+} WorldConfig_t;
+
+typedef struct {
+  char name[PARAM_NAME];
+  WorldConfig_t world;
+  int32_t tune[PARAM_STATES][PARAM_FIELDS];
+  uint8_t set[PARAM_STATES][PARAM_FIELDS]; // 1 where tune replaces fsm[]
+  int32_t param[ROBOT_PARAMS];
+  uint8_t paramSet[ROBOT_PARAMS]; // 1 where param replaces the #define
+} Param_t;
+
+// ------------Param_Default------------
+// A set with the default world and fsm[] as built
+void Param_Default(Param_t *p, const char *name);
+
+// ------------Param_Set------------
+// Input: key and value as in a parameter line
+// Output: 0 if set, -1 if the key or value is not valid
+int Param_Set(Param_t *p, const char *key, const char *value);
+
+// ------------Param_Parse------------
+// Fill a set from one line, over the defaults
+// Input: line, modified
+// Output: 0 if a set was read, 1 for a blank or comment line,
+//         -1 with the bad key in p->name
+int Param_Parse(Param_t *p, char *line);
+
+// ------------Param_State------------
+// Output: index into fsm[] of a state name, -1 if unknown
+int32_t Param_State(const char *name);
+
+// ------------Param_StateName------------
+// Output: name of fsm[i]
+const char *Param_StateName(uint32_t i);
+
+// ------------Param_FieldName------------
+// Output: left, right or delay
+const char *Param_FieldName(uint32_t field);
+
+// ------------Param_ParamName------------
+// Output: name of the #define of ROBOT_PARAM id
+const char *Param_ParamName(uint32_t id);
+
+// ------------Param_Write------------
+// The set as one line, the world and whatever replaces the
+// firmware's values, without the newline
+// Input: set, buffer and its size
+// Output: length of the line, truncated if above size - 1
+int Param_Write(const Param_t *p, char *line, size_t size);
+
+#endif
@@ -0,0 +1,141 @@
+// Pool.c
+// Runs on the host, not the robot
+// One deque of job numbers per worker, [head, tail).  The owner
+// pops from the tail, thieves steal from the head, both under the
+// deque's lock.  The jobs are simulations of milliseconds or
+// more, so a mutex per deque costs nothing that shows.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "Pool.h"
+
+typedef struct {
+  pthread_mutex_t lock;
+  uint32_t head, tail;
+} Deque_t;
+
+typedef struct Pool {
+  Deque_t *deque;
+  uint32_t threads;
+  uint32_t remaining;             // jobs not yet finished, atomic
+  void (*job)(void *arg, uint32_t i);
+  void *arg;
+} Pool_t;
+
+typedef struct {
+  Pool_t *pool;
+  uint32_t id;
+} Worker_t;
+
+uint32_t Pool_Cores(void){
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return (n > 0) ? (uint32_t)n : 1;
+}
+
+// owner end, 1 with a job in *i
+static int Pool_Pop(Deque_t *d, uint32_t *i){
+  int got = 0;
+  pthread_mutex_lock(&d->lock);
+  if(d->tail > d->head){
+    *i = --d->tail;
+    got = 1;
+  }
+  pthread_mutex_unlock(&d->lock);
+  return got;
+}
+
+// move the first half of victim's jobs to own, 1 if any moved
+static int Pool_Steal(Deque_t *victim, Deque_t *own){
+  uint32_t head, n;
+  pthread_mutex_lock(&victim->lock);
+  n = victim->tail - victim->head;
+  n = (n + 1)/2;
+  head = victim->head;
+  victim->head += n;
+  pthread_mutex_unlock(&victim->lock);
+  if(n == 0){
+    return 0;
+  }
+  pthread_mutex_lock(&own->lock);
+  own->head = head;
+  own->tail = head + n;
+  pthread_mutex_unlock(&own->lock);
+  return 1;
+}
+
+static void *Pool_Worker(void *p){
+  Worker_t *w = p;
+  Pool_t *pool = w->pool;
+  Deque_t *own = &pool->deque[w->id];
+  uint32_t i, k, victim;
+  uint32_t seed = w->id*2654435761u + 1;
+  while(__atomic_load_n(&pool->remaining, __ATOMIC_ACQUIRE)){
+    if(Pool_Pop(own, &i)){
+      pool->job(pool->arg, i);
+      __atomic_sub_fetch(&pool->remaining, 1, __ATOMIC_ACQ_REL);
+      continue;
+    }
+    // own deque is empty: try every other worker once, from a random one
+    seed = seed*1664525 + 1013904223;
+    victim = seed%pool->threads;
+    for(k = 0; k < pool->threads; k++, victim = (victim + 1)%pool->threads){
+      if((victim != w->id) && Pool_Steal(&pool->deque[victim], own)){
+        break;
+      }
+    }
+    if(k == pool->threads){
+      sched_yield();                  // the last jobs are running elsewhere
+    }
+  }
+  return 0;
+}
+
+void Pool_Run(uint32_t threads, uint32_t jobs, void (*job)(void *arg, uint32_t i), void *arg){
+  Pool_t pool;
+  Worker_t *worker;
+  pthread_t *thread;
+  uint32_t t;
+  if(threads == 0) threads = Pool_Cores();
+  if(threads > POOL_MAX_THREADS) threads = POOL_MAX_THREADS;
+  if(threads > jobs) threads = jobs ? jobs : 1;
+  pool.threads = threads;
+  pool.remaining = jobs;
+  pool.job = job;
+  pool.arg = arg;
+  pool.deque = calloc(threads, sizeof(Deque_t));
+  worker = calloc(threads, sizeof(Worker_t));
+  thread = calloc(threads, sizeof(pthread_t));
+  if(!pool.deque || !worker || !thread){
+    for(t = 0; t < jobs; t++){
+      job(arg, t);                    // no memory for a pool, run them here
+    }
+  }else{
+    for(t = 0; t < threads; t++){
+      pthread_mutex_init(&pool.deque[t].lock, 0);
+      pool.deque[t].head = (uint32_t)(((uint64_t)jobs*t)/threads);
+      pool.deque[t].tail = (uint32_t)(((uint64_t)jobs*(t + 1))/threads);
+      worker[t].pool = &pool;
+      worker[t].id = t;
+    }
+    for(t = 1; t < threads; t++){
+      if(pthread_create(&thread[t], 0, Pool_Worker, &worker[t])){
+        thread[t] = 0;                // its block is stolen by the others
+      }
+    }
+    Pool_Worker(&worker[0]);          // the caller is worker 0
+    for(t = 1; t < threads; t++){
+      if(thread[t]){
+        pthread_join(thread[t], 0);
+      }
+    }
+    for(t = 0; t < threads; t++){
+      pthread_mutex_destroy(&pool.deque[t].lock);
+    }
+  }
+  free(pool.deque);
+  free(worker);
+  free(thread);
+}
@@ -0,0 +1,28 @@
+// Pool.h
+// Runs on the host, not the robot
+// Work-stealing thread pool for a batch of independent jobs.
+// Each worker starts with a contiguous block of the job numbers
+// and works it from the top.  A worker that runs out takes the
+// bottom half of what another has left, so a block of slow runs
+// (a hard course, a bad parameter set) is spread over the pool
+// instead of holding up its one thread.
+
+#ifndef POOL_H_
+#define POOL_H_
+#include <stdint.h>
+
+#define POOL_MAX_THREADS 256
+
+// ------------Pool_Run------------
+// Run job(arg, i) for every i in 0 to jobs-1 and return when all
+// are done.  Jobs run in any order, on any thread.
+// Input: worker threads (0 for one per core), number of jobs,
+//        the job and its argument
+// Output: none
+void Pool_Run(uint32_t threads, uint32_t jobs, void (*job)(void *arg, uint32_t i), void *arg);
+
+// ------------Pool_Cores------------
+// Output: cores online, at least 1
+uint32_t Pool_Cores(void);
+
+#endif
@@ -0,0 +1,100 @@
+// Sensor.c
+// Runs on the host, not the robot
+// Only the gather of the four pixels around each sensor is done
+// lane by lane, there is no portable vector gather.  Sample
+// points are clamped to the raster, whose edge is white on every
+// course, so a robot driving off it sees no line.
+
+#include <stdint.h>
+#include <math.h>
+#include "Sensor.h"
+
+// sensor b, lane b, Reflectance.c weight[7-b] in mm
+static const float Offset[8] = {33.4f, 23.8f, 14.3f, 4.8f, -4.8f, -14.3f, -23.8f, -33.4f};
+
+void Sensor_Init(Sensor_t *s, double array, const double *gain){
+  int b;
+  for(b = 0; b < 8; b++){
+    s->offset[b] = Offset[b];
+    s->gain[b] = (float)gain[b];
+  }
+  s->array = (float)array;
+}
+
+// *v = min(max(*v, 0), hi) lane by lane, by pointer: a 32 byte
+// vector return value has no ABI without AVX
+static inline void Sensor_Clamp(SensorVec *v, float hi){
+  SensorVec h = {hi, hi, hi, hi, hi, hi, hi, hi};
+  SensorInt r = (SensorInt)*v & ~(*v < 0);
+  SensorInt above = (SensorVec)r > h;
+  *v = (SensorVec)((r & ~above) | ((SensorInt)h & above));
+}
+
+uint8_t Sensor_Read(const Sensor_t *s, const Course_t *c, double x, double y, double heading, float *decay){
+  const float scale = (float)(1/c->mmPerPixel);
+  const float cs = (float)cos(heading), sn = (float)sin(heading);
+  const float fx = (float)x + s->array*cs, fy = (float)y + s->array*sn;
+  const uint8_t *dark = c->dark;
+  SensorVec px, py, ax, ay, p00, p10, p01, p11, top, bottom, t;
+  SensorInt ix, iy, high;
+  uint32_t b, bits = 0;
+  // pixel centers are at +0.5, step back so the integer part is the upper left pixel
+  px = (fx - s->offset*sn)*scale - 0.5f;
+  py = (fy + s->offset*cs)*scale - 0.5f;
+  Sensor_Clamp(&px, c->width - 1.001f);
+  Sensor_Clamp(&py, c->height - 1.001f);
+  ix = __builtin_convertvector(px, SensorInt);
+  iy = __builtin_convertvector(py, SensorInt);
+  ax = px - __builtin_convertvector(ix, SensorVec);
+  ay = py - __builtin_convertvector(iy, SensorVec);
+  for(b = 0; b < 8; b++){
+    uint32_t u = ix[b], v = iy[b];
+    p00[b] = dark[Course_Pixel(c, u, v)];
+    p10[b] = dark[Course_Pixel(c, u + 1, v)];
+    p01[b] = dark[Course_Pixel(c, u, v + 1)];
+    p11[b] = dark[Course_Pixel(c, u + 1, v + 1)];
+  }
+  top = p00 + (p10 - p00)*ax;
+  bottom = p01 + (p11 - p01)*ax;
+  t = (SENSOR_WHITE_US + (top + (bottom - top)*ay)*((SENSOR_BLACK_US - SENSOR_WHITE_US)/255))*s->gain;
+  high = t > SENSOR_READ_US;
+  for(b = 0; b < 8; b++){
+    decay[b] = t[b];
+    bits |= high[b]&(1 << b);
+  }
+  return bits;
+}
+
+uint8_t Sensor_ReadScalar(const Sensor_t *s, const Course_t *c, double x, double y, double heading, float *decay){
+  const float scale = (float)(1/c->mmPerPixel);
+  const float cs = (float)cos(heading), sn = (float)sin(heading);
+  const float fx = (float)x + s->array*cs, fy = (float)y + s->array*sn;
+  uint32_t b, u, v;
+  float px, py, ax, ay, top, bottom;
+  for(b = 0; b < 8; b++){
+    px = (fx - s->offset[b]*sn)*scale - 0.5f;
+    py = (fy + s->offset[b]*cs)*scale - 0.5f;
+    if(px < 0) px = 0;
+    if(px > c->width - 1.001f) px = c->width - 1.001f;
+    if(py < 0) py = 0;
+    if(py > c->height - 1.001f) py = c->height - 1.001f;
+    u = (uint32_t)px;
+    v = (uint32_t)py;
+    ax = px - u;
+    ay = py - v;
+    top = c->dark[Course_Pixel(c, u, v)] + (c->dark[Course_Pixel(c, u + 1, v)] - c->dark[Course_Pixel(c, u, v)])*ax;
+    bottom = c->dark[Course_Pixel(c, u, v + 1)] + (c->dark[Course_Pixel(c, u + 1, v + 1)] - c->dark[Course_Pixel(c, u, v + 1)])*ax;
+    decay[b] = (SENSOR_WHITE_US + (top + (bottom - top)*ay)*((SENSOR_BLACK_US - SENSOR_WHITE_US)/255))*s->gain[b];
+  }
+  return Sensor_Bits(decay, SENSOR_READ_US);
+}
+
+uint8_t Sensor_Bits(const float *decay, float us){
+  uint32_t b, bits = 0;
+  for(b = 0; b < 8; b++){
+    if(decay[b] > us){
+      bits |= 1 << b;
+    }
+  }
+  return bits;
+}
@@ -0,0 +1,55 @@
+// Sensor.h
+// Runs on the host, not the robot
+// The QTR-8RC array against a course, all eight sensors at once.
+// The sensor positions are transformed as one 8-lane vector (GCC
+// vector extensions, so SSE or AVX as the target allows, plain C
+// elsewhere), the floor is sampled bilinearly between pixels,
+// and each sensor gives the time its capacitor takes to decay,
+// as the RC circuit would: SENSOR_WHITE_US on white floor up to
+// SENSOR_BLACK_US on black tape.  A bit is 1 while its sensor is
+// still high when it is read, SENSOR_READ_US after the charge,
+// which is when Reflectance_End reads it on the robot.
+// Lane b is sensor b of the reflectance data, weight[7-b] um to
+// the right of center, so bit 7 is on the robot's left.
+
+#ifndef SENSOR_H_
+#define SENSOR_H_
+#include <stdint.h>
+#include "Course.h"
+
+#define SENSOR_WHITE_US 250.0f
+#define SENSOR_BLACK_US 2500.0f
+#define SENSOR_READ_US 1000.0f    // Reflectance_Start to Reflectance_End
+
+typedef float SensorVec __attribute__((vector_size(32)));
+typedef int32_t SensorInt __attribute__((vector_size(32)));
+
+typedef struct {
+  SensorVec offset;               // mm to the right of center, by lane
+  SensorVec gain;                 // decay time error of each sensor
+  float array;                    // mm ahead of the axle
+} Sensor_t;
+
+// ------------Sensor_Init------------
+// Input: mm from the axle to the array, decay gain of each
+//        sensor (1 is nominal), in bit order
+void Sensor_Init(Sensor_t *s, double array, const double *gain);
+
+// ------------Sensor_Read------------
+// Sample the course under the array
+// Input: pose of the axle, mm and rad in the image frame, where to
+//        put the decay time of each sensor in us (bit order)
+// Output: 8-bit reflectance data read at SENSOR_READ_US, 1 is dark
+uint8_t Sensor_Read(const Sensor_t *s, const Course_t *c, double x, double y, double heading, float *decay);
+
+// ------------Sensor_ReadScalar------------
+// Sensor_Read one sensor at a time, the reference it is checked
+// and timed against
+uint8_t Sensor_ReadScalar(const Sensor_t *s, const Course_t *c, double x, double y, double heading, float *decay);
+
+// ------------Sensor_Bits------------
+// Input: decay times, us after the charge the pins are read
+// Output: 8-bit reflectance data, what Reflectance_Read(us) gives
+uint8_t Sensor_Bits(const float *decay, float us);
+
+#endif
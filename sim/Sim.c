@@ -0,0 +1,120 @@
+// Sim.c
+// Runs on the host, not the robot
+// The tick loop.  Each ms the robot moves for the last ms, the
+// TimerA1 latch applies what control posted, and SysTick releases
+// the tasks that are due, in priority order, each run to the end.
+
+#include <stdint.h>
+#include <string.h>
+#include "Sim.h"
+#include "Lap.h"
+#include "Maze.h"
+
+extern ROBOT_LOCAL Lap_t Laps;
+extern ROBOT_LOCAL Maze_t Maze;
+
+void Sim_Run(const SimJob_t *job, SimResult_t *result){
+  Sim_t s;
+  uint32_t i;
+  memset(&s, 0, sizeof(s));
+  memset(result, 0, sizeof(SimResult_t));
+  s.job = job;
+  s.result = result;
+  World_Init(&s.world, job->course, &job->param->world, job->seed);
+  Sim = &s;
+  Hal_Reset();
+  robot_main();
+  for(i = 0; i < TRACE_INTERVALS; i++){
+    memcpy(result->latency[i], Trace_Histogram(i), sizeof(result->latency[i]));
+    result->latencyWorst[i] = Trace_Worst(i);
+  }
+  Sim = 0;
+}
+
+// the lap markers, after the axle moved from (x0,y0)
+static void Sim_Gates(Sim_t *s, double x0, double y0){
+  const Course_t *c = s->job->course;
+  if((s->gate < c->gates) && Course_Crossed(c->gate[s->gate], x0, y0, s->world.x, s->world.y)){
+    if(s->gate == 0){
+      s->result->gateLaps += s->gateRunning;
+      s->gateRunning = 1;
+    }
+    s->gate = (s->gate + 1)%c->gates;
+  }
+}
+
+// Maze course, the robot has stopped.  The end of the
+// exploration or of the fast run is a lap, after the exploration
+// the robot is carried back and tapped to start the fast run.
+// Output: 1 if the run is over
+static uint32_t Sim_Goal(Sim_t *s, uint32_t laps){
+  SimResult_t *r = s->result;
+  if(Maze.phase != ((r->laps == 0) ? MAZE_SOLVED : MAZE_FINISHED)){
+    r->outcome = SIM_STOPPED;     // gave up, crashed or no way to the goal
+    return 1;
+  }
+  r->lapMs[r->laps] = s->ms - s->lapMs;
+  r->laps++;
+  if(r->laps >= laps){
+    r->outcome = SIM_FINISHED;
+    return 1;
+  }
+  World_Place(&s->world);
+  s->lapMs = s->lineMs = s->ms;
+  s->stopped = s->moved = 0;      // Stop posts again, only a stop after moving counts
+  s->bump = 0x01;
+  PORT4_IRQHandler();             // pressed
+  s->bump = 0;                    // and let go before the next FSM step
+  return 0;
+}
+
+void Sim_Loop(void){
+  Sim_t *s = Sim;
+  const SimJob_t *job = s->job;
+  SimResult_t *r = s->result;
+  uint32_t i, laps = (job->laps < SIM_MAX_LAPS) ? job->laps : SIM_MAX_LAPS;
+  double x, y;
+  if((job->course->kind == COURSE_KIND_MAZE) && (laps > SIM_MAZE_LAPS)){
+    laps = SIM_MAZE_LAPS;
+  }
+  r->outcome = SIM_TIMEOUT;
+  for(s->ms = 1; s->ms <= job->limitMs; s->ms++){
+    x = s->world.x;
+    y = s->world.y;
+    World_Step(&s->world, 0.001);
+    Sim_Gates(s, x, y);
+    if(!Course_Inside(job->course, s->world.x, s->world.y) ||
+       (s->ms - s->lineMs > SIM_LOST_MS)){
+      r->outcome = SIM_LOST;
+      break;
+    }
+    Hal_Latch();
+    for(i = 0; i < s->tasks; i++){
+      if(s->period[i] && ((s->ms % s->period[i]) == 0)){
+        s->task[i]();
+      }
+    }
+    if((job->course->kind == COURSE_KIND_LINE) && (Laps.laps != r->laps)){
+      r->lapMs[r->laps] = Laps.time[r->laps%LAP_RESULTS];
+      r->laps++;
+      if(job->course->gates && (r->gateLaps < r->laps)){
+        r->outcome = SIM_MISCOUNT;
+        break;
+      }
+      if(r->laps >= laps){
+        r->outcome = SIM_FINISHED;
+        break;
+      }
+    }
+    if(s->stopped){
+      if(job->course->kind != COURSE_KIND_MAZE){
+        r->outcome = SIM_STOPPED;
+        break;
+      }
+      if(Sim_Goal(s, laps)){
+        break;
+      }
+    }
+  }
+  r->ms = s->ms;
+}
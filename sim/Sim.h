@@ -0,0 +1,100 @@
+// Sim.h
+// Runs on the host, not the robot
+// One simulated run: the firmware of LineFollowFSMmain.c, with
+// its own copy of every global, drives a World_t around a course
+// in 1 ms ticks until it has run the laps asked for or failed.
+// Laps are the ones the robot times itself, from the bar.  On a
+// course with lap markers the simulator also counts the laps the
+// axle really drove, and a lap the robot counts ahead of them
+// ends the run.  On a maze course the laps are the exploration,
+// from the start until the robot stops with the maze solved, and
+// the fast run: the robot is put back at the start and its bump
+// switches tapped, as it is done by hand.  The maze course needs
+// the firmware built for it, see the Makefile.
+// Sim_Run can be called from any number of threads at once.
+
+#ifndef SIM_H_
+#define SIM_H_
+#include <stdint.h>
+#include "OS.h"
+#include "Course.h"
+#include "Param.h"
+#include "World.h"
+#include "Trace.h"
+
+// how a run ended
+#define SIM_FINISHED 0            // ran the laps asked for
+#define SIM_LOST 1                // no line under the array for SIM_LOST_MS, or off the course
+#define SIM_STOPPED 2             // the FSM stopped on its own, gave up or braked
+#define SIM_TIMEOUT 3             // still going at limitMs
+#define SIM_MISCOUNT 4            // counted a lap the lap markers did not see
+#define SIM_OUTCOMES 5
+
+#define SIM_LOST_MS 3000
+#define SIM_MAX_LAPS 32           // lap times kept per run
+#define SIM_MAZE_LAPS 2           // exploration and fast run
+
+typedef struct {
+  const Course_t *course;
+  const Param_t *param;
+  uint32_t seed;
+  uint32_t laps;                  // laps to finish, at most SIM_MAX_LAPS
+  uint32_t limitMs;               // simulated time allowed
+  Param_t *built;                 // 0, or filled with the firmware's own values
+                                  // of every state and constant the run reads
+} SimJob_t;
+
+typedef struct {
+  uint32_t outcome;               // SIM_FINISHED to SIM_MISCOUNT
+  uint32_t laps;                  // laps completed
+  uint32_t gateLaps;              // laps driven by the lap markers
+  uint32_t lapMs[SIM_MAX_LAPS];   // time of each lap
+  uint32_t ms;                    // simulated time of the run
+  uint32_t frames;                // reflectance frames read
+  uint32_t lostFrames;            // frames with no line under the array
+  uint32_t latency[TRACE_INTERVALS][TRACE_BINS]; // the tracer's histograms at the end
+  uint32_t latencyWorst[TRACE_INTERVALS];        // us
+} SimResult_t;
+
+// ------------Sim_Run------------
+// Run the firmware once
+// Input: what to run, where to put the result
+// Output: none
+void Sim_Run(const SimJob_t *job, SimResult_t *result);
+
+// State of the run on this thread, for the stand-ins in Hal.c
+typedef struct {
+  const SimJob_t *job;
+  SimResult_t *result;
+  World_t world;
+  uint32_t ms;                    // ticks so far
+  void (*task[OS_TASKS])(void);
+  uint32_t period[OS_TASKS];      // ms, 0 for the background task
+  uint32_t tasks;
+  int16_t postLeft, postRight;    // Actuate_Command waiting for the latch
+  uint8_t postMode, posted;
+  uint32_t moved;                 // 1 once a wheel was driven
+  uint32_t stopped;               // 1 once ACTUATE_STOP came after moving
+  uint32_t lineMs;                // tick the line was last under the array
+  uint32_t lapMs;                 // tick the maze run in progress began
+  uint32_t gate;                  // lap marker to cross next
+  uint32_t gateRunning;           // 1 once gate 0 has been crossed
+  uint8_t bump;                   // bump switches pressed, Bump_Read
+} Sim_t;
+
+extern _Thread_local Sim_t *Sim;
+
+// ------------Sim_Loop------------
+// The ticks of a run, called from OS_Launch
+void Sim_Loop(void);
+
+// ------------Hal_Latch------------
+// The TimerA1 latch, applies the command posted before this tick
+void Hal_Latch(void);
+
+// firmware state the simulator watches or resets
+void Hal_Reset(void);
+int robot_main(void);
+void PORT4_IRQHandler(void);
+
+#endif
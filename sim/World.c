@@ -0,0 +1,87 @@
+// World.c
+// Runs on the host, not the robot
+// Kinematics and sensing.  The wheels are integrated exactly for
+// an arc over each step, which at 1 ms steps is only tidier than
+// Euler, not more accurate.
+
+#include <stdint.h>
+#include <math.h>
+#include "World.h"
+
+#define PI 3.14159265358979323846
+
+// uniform in [-1, 1)
+static double World_Uniform(World_t *w){
+  return (World_Random(w)/2147483648.0) - 1.0;
+}
+
+void World_Init(World_t *w, const Course_t *c, const WorldConfig_t *cfg, uint32_t seed){
+  double gain[8];
+  int b;
+  w->course = c;
+  w->rng = seed*2654435761u + 0x9E3779B9u;
+  if(w->rng == 0){
+    w->rng = 1;
+  }
+  World_Random(w);
+  w->gainLeft = 1 + cfg->mismatch*World_Uniform(w);
+  w->gainRight = 1 + cfg->mismatch*World_Uniform(w);
+  w->lag = cfg->lag/1000;
+  w->wheelbase = cfg->wheelbase;
+  w->jitter = cfg->jitter;
+  w->yaw = cfg->yaw;
+  for(b = 0; b < 8; b++){
+    gain[b] = 1 + cfg->sensor*World_Uniform(w);
+  }
+  Sensor_Init(&w->sensor, cfg->array, gain);
+  w->glitch = (cfg->glitch >= 1) ? 0xFFFFFFFF : (uint32_t)(cfg->glitch*4294967296.0);
+  w->travel = 0;
+  World_Place(w);
+}
+
+void World_Place(World_t *w){
+  const Course_t *c = w->course;
+  double across = w->jitter*World_Uniform(w);
+  w->heading = c->startHeading + w->yaw*World_Uniform(w)*PI/180;
+  w->x = c->startX - across*sin(c->startHeading);
+  w->y = c->startY + across*cos(c->startHeading);
+  w->left = w->right = 0;
+  w->targetLeft = w->targetRight = 0;
+}
+
+void World_Drive(World_t *w, double left, double right){
+  w->targetLeft = left*w->gainLeft;
+  w->targetRight = right*w->gainRight;
+}
+
+void World_Step(World_t *w, double dt){
+  double k = (w->lag > dt) ? dt/w->lag : 1;
+  double v, turn;
+  w->left += (w->targetLeft - w->left)*k;
+  w->right += (w->targetRight - w->right)*k;
+  w->travel += (fabs(w->left) + fabs(w->right))*dt;
+  v = (w->left + w->right)/2;
+  turn = (w->left - w->right)*dt/w->wheelbase;  // clockwise, to the right
+  if(fabs(turn) < 1e-9){
+    w->x += v*dt*cos(w->heading);
+    w->y += v*dt*sin(w->heading);
+  }else{
+    double r = v*dt/turn;                       // signed radius
+    w->x += r*(sin(w->heading + turn) - sin(w->heading));
+    w->y -= r*(cos(w->heading + turn) - cos(w->heading));
+  }
+  w->heading += turn;
+}
+
+uint8_t World_Sense(World_t *w){
+  uint8_t data = Sensor_Read(&w->sensor, w->course, w->x, w->y, w->heading, w->decay);
+  int b;
+  if(w->glitch){
+    for(b = 0; b < 8; b++){
+      if(World_Random(w) < w->glitch){
+        data ^= 1 << b;
+      }
+    }
+  }
+  return data;
+}
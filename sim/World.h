@@ -0,0 +1,66 @@
+// World.h
+// Runs on the host, not the robot
+// The robot as the simulator moves it: a differential drive with
+// a first order lag on each wheel, and the eight reflectance
+// sensors in a row across the front, read through Sensor.h.
+
+#ifndef WORLD_H_
+#define WORLD_H_
+#include <stdint.h>
+#include "Course.h"
+#include "Param.h"
+#include "Sensor.h"
+
+typedef struct {
+  const Course_t *course;
+  double x, y;                    // mm, axle center
+  double heading;                 // rad, image frame
+  double left, right;             // mm/s, wheel speed now
+  double travel;                  // mm, both wheels, forward or back, as the encoders count
+  double targetLeft, targetRight; // mm/s, as driven
+  double gainLeft, gainRight;     // this run's wheel speed error
+  double lag;                     // s, motor time constant
+  double wheelbase;               // mm
+  double jitter, yaw;             // mm, deg, of the start pose
+  Sensor_t sensor;                // this run's array
+  float decay[8];                 // us, of the last World_Sense, bit order
+  uint32_t glitch;                // chance of a wrong bit, of 2^32
+  uint32_t rng;                   // xorshift32 state, never 0
+} World_t;
+
+// ------------World_Init------------
+// Put the robot at the start of a course, stopped
+// Input: the course, the world of the parameter set, a seed that
+//        picks the wheel errors, start pose and sensor glitches
+void World_Init(World_t *w, const Course_t *c, const WorldConfig_t *cfg, uint32_t seed);
+
+// ------------World_Place------------
+// Put the robot back at the start, stopped, as a hand would
+// Input: the robot, World_Init has been called
+void World_Place(World_t *w);
+
+// ------------World_Drive------------
+// Wheel speeds the motors are driven toward
+// Input: mm/s, negative is backward
+void World_Drive(World_t *w, double left, double right);
+
+// ------------World_Step------------
+// Move the robot on for dt s
+void World_Step(World_t *w, double dt);
+
+// ------------World_Sense------------
+// Read the sensors where the robot is now, keeps the decay times
+// Output: 8-bit reflectance data at SENSOR_READ_US, 1 is dark
+uint8_t World_Sense(World_t *w);
+
+// ------------World_Random------------
+// Output: next number of the run's generator
+static inline uint32_t World_Random(World_t *w){
+  uint32_t r = w->rng;
+  r ^= r << 13;
+  r ^= r >> 17;
+  r ^= r << 5;
+  return w->rng = r;
+}
+
+#endif
@@ -0,0 +1,121 @@
+// bench.c
+// Runs on the host, not the robot
+// Times the sensor engine on one thread.
+//   bench [-n frames] [-c course]
+// Reads frames with Sensor_Read and with the one-sensor-at-a-time
+// Sensor_ReadScalar from the same poses, checks they agree, and
+// prints frames per second for each.  Poses either follow the
+// course the way a run does (walk: a few mm a frame, the cache
+// stays warm) or jump anywhere on the raster (random: nearly
+// every frame misses the cache).
+//   -n  frames per test, default 10000000
+//   -c  course, built in or a course file, default oval
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "Sensor.h"
+
+#define BENCH_POSES 4096          // precomputed, reused in turn
+
+typedef uint8_t (*Read_t)(const Sensor_t *, const Course_t *, double, double, double, float *);
+
+static double Bench_Now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec/1e9;
+}
+
+static double Bench_Time(Read_t read, const Sensor_t *s, const Course_t *c, const double (*pose)[3],
+                         uint32_t frames, uint32_t *sum){
+  float decay[8];
+  uint32_t i, acc = 0;
+  double t0 = Bench_Now();
+  for(i = 0; i < frames; i++){
+    const double *p = pose[i%BENCH_POSES];
+    acc += read(s, c, p[0], p[1], p[2], decay);
+  }
+  *sum = acc;
+  return frames/(Bench_Now() - t0);
+}
+
+int main(int argc, char **argv){
+  static double pose[BENCH_POSES][3];
+  const char *name = "oval";
+  const double gain[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+  uint32_t frames = 10000000, i, b, test, bad = 0, sum[2], dark = 0;
+  float dv[8], ds[8];
+  double x, y, h, width, height;
+  Sensor_t s;
+  Course_t *c;
+  int opt;
+  while((opt = getopt(argc, argv, "n:c:")) != -1){
+    switch(opt){
+      case 'n': frames = strtoul(optarg, 0, 10); break;
+      case 'c': name = optarg; break;
+      default:
+        fprintf(stderr, "usage: bench [-n frames] [-c course]\n");
+        return 2;
+    }
+  }
+  c = Course_Open(name);
+  if(c == 0){
+    return 1;
+  }
+  Sensor_Init(&s, 70, gain);
+  width = c->width*c->mmPerPixel;
+  height = c->height*c->mmPerPixel;
+  srand(1);
+  for(test = 0; test < 2; test++){
+    x = c->startX;
+    y = c->startY;
+    h = c->startHeading;
+    for(i = 0; i < BENCH_POSES; i++){
+      if(test == 0){                  // about 1 m/s at a frame a ms, wandering
+        h += 0.02*(rand()/(double)RAND_MAX - 0.5);
+        x += cos(h);
+        y += sin(h);
+        if((x < 0) || (y < 0) || (x >= width) || (y >= height)){
+          x = c->startX;
+          y = c->startY;
+        }
+      }else{
+        x = width*rand()/(double)RAND_MAX;
+        y = height*rand()/(double)RAND_MAX;
+        h = 6.283185307179586*rand()/(double)RAND_MAX;
+      }
+      pose[i][0] = x;
+      pose[i][1] = y;
+      pose[i][2] = h;
+    }
+    for(i = 0; i < BENCH_POSES; i++){
+      uint8_t v = Sensor_Read(&s, c, pose[i][0], pose[i][1], pose[i][2], dv);
+      uint8_t r = Sensor_ReadScalar(&s, c, pose[i][0], pose[i][1], pose[i][2], ds);
+      for(b = 0; b < 8; b++){
+        if(fabsf(dv[b] - ds[b]) > 0.01f){
+          bad++;
+        }
+      }
+      bad += (v != r);
+      dark += (v != 0);
+    }
+    printf("%-6s %s: vector %.1f M frames/s, scalar %.1f M frames/s, %u of %u frames see tape\n",
+           test ? "random" : "walk", c->name,
+           Bench_Time(Sensor_Read, &s, c, (const double (*)[3])pose, frames, &sum[0])/1e6,
+           Bench_Time(Sensor_ReadScalar, &s, c, (const double (*)[3])pose, frames, &sum[1])/1e6,
+           dark, BENCH_POSES);
+    dark = 0;
+    if(sum[0] != sum[1]){
+      bad++;
+    }
+  }
+  if(bad){
+    printf("vector and scalar disagree %u times\n", bad);
+  }
+  Course_Free(c);
+  return bad != 0;
+}
@@ -0,0 +1,206 @@
+// check.c
+// Runs on the host, not the robot
+// Checks of the per-frame filters of the firmware, fed made-up
+// or recorded frames instead of a simulated run.
+//   check
+// Run it from sim/, the traces are read from traces/.
+// Prints one line per failed check and exits 1 if any failed.
+// make suite runs it before the courses.
+
+#include <stdio.h>
+#include <stdint.h>
+#include "Sim.h"
+#include "SpeedGovernor.h"
+#include "Lap.h"
+#include "LineHistory.h"
+#include "MotorCal.h"
+#include "Motor.h"
+#include "Odometry.h"
+#include "Tachometer.h"
+#include "Flash.h"
+#include "ReflectFilter.h"
+
+#define CHECK_TRACE "traces/wander.txt"
+
+static uint32_t Failed;
+
+static void Check(int ok, const char *what){
+  if(!ok){
+    printf("FAIL %s\n", what);
+    Failed = Failed + 1;
+  }
+}
+
+// The boost ramps to its cap on a straight, then the line
+// starts to wander: the duty has to come down on the first
+// frame the variance is over GOVERNOR_VAR_DRIFT.
+static void Check_Governor(void){
+  SpeedGovernor_t g;
+  int16_t base = 6700, duty;
+  uint32_t i;
+  Governor_Init(&g);
+  for(i = 0; i < 500; i++){
+    Governor_Add(&g, 0x18, base);       // centered
+  }
+  duty = Governor_Duty(&g, base);
+  Check(duty == GOVERNOR_MAX_DUTY, "governor ramps to GOVERNOR_MAX_DUTY on a straight");
+  Check(g.boost == GOVERNOR_MAX_DUTY - base, "governor boost stops at GOVERNOR_MAX_DUTY minus base");
+  Governor_Add(&g, 0x80, base);         // far left, the variance jumps
+  Check(Governor_Duty(&g, base) < duty, "governor duty drops on the first drifting frame");
+}
+
+// Drive over mm of frames all reading data, 3 mm a frame
+// Output: frames on which Lap_Frame confirmed the bar
+static uint32_t Lap_Drive(Lap_t *l, uint8_t data, int32_t *distance, int32_t mm){
+  uint32_t marks = 0;
+  int32_t end = *distance + mm;
+  while(*distance < end){
+    marks += Lap_Frame(l, data, (uint32_t)*distance, *distance);
+    *distance += 3;
+  }
+  return marks;
+}
+
+// A line crossed at right angles reads 0xFF over about its own
+// 19 mm and must not be taken for the bar, which is longer.
+static void Check_Lap(void){
+  Lap_t l;
+  int32_t d = 0;
+  Lap_Init(&l);
+  Lap_Drive(&l, 0x18, &d, 100);
+  Check(Lap_Drive(&l, 0xFF, &d, 19) == 0, "lap ignores a 19 mm crossing before the first bar");
+  Lap_Drive(&l, 0x18, &d, 100);
+  Check(Lap_Drive(&l, 0xFF, &d, 60) == 1, "lap starts once on a 60 mm bar");
+  Check(l.running == 1, "lap clock runs after the bar");
+  Lap_Drive(&l, 0x18, &d, 1000);
+  Lap_Drive(&l, 0xFF, &d, 19);
+  Lap_Drive(&l, 0x18, &d, 1000);
+  Check(l.laps == 0, "lap ignores a 19 mm crossing in a lap");
+  Lap_Drive(&l, 0xFF, &d, LAP_BAR_MM + 3);
+  Lap_Drive(&l, 0x18, &d, 100);
+  Check(l.laps == 1, "lap counts a LAP_BAR_MM bar");
+}
+
+// Frames read leaving the lap bar tilted, recorded in the
+// simulator on cross: the line goes off the right of the array
+// while what is left of the bar still covers the left.  Runs no
+// wider than the tape are the line, the bar is not.
+static const uint8_t BarRight[] = {0x18, 0x18, 0x0f, 0x1f, 0x3f, 0x7f, 0xff, 0xff, 0xff,
+  0xfb, 0xe3, 0xc3, 0x83, 0x01, 0x00};
+static const uint8_t BarRightLate[] = {0x18, 0x18, 0x0f, 0x1f, 0x3f, 0x7f, 0xff, 0xff, 0xff,
+  0xfd, 0xf9, 0xf1, 0xe1, 0xe0, 0xc0, 0x80, 0x00};
+
+static int32_t History_Feed(const uint8_t *data, uint32_t n){
+  LineHistory_t h;
+  uint32_t i;
+  LineHistory_Init(&h);
+  for(i = 0; i < n; i++){
+    LineHistory_Add(&h, data[i]);
+  }
+  return LineHistory_ExitSide(&h);
+}
+
+static void Check_History(void){
+  Check(History_Feed(BarRight, sizeof(BarRight)) == 1, "history keeps the line, not the bar, in two-run frames");
+  Check(History_Feed(BarRightLate, sizeof(BarRightLate)) == 1, "history drops the bar left after the line has gone");
+}
+
+// traces/wander.txt, 2000 frames of a line wandering under the
+// array with one bit in 20 frames flipped, the trace of
+// tools/glitchtrace.  A blip is a pattern unlike the frames on
+// both sides of it: 149 raw, 8 after the vote of 3.  The vote
+// has to take out most of them and must not add changes.
+static void Check_Filter(void){
+  FILE *in = fopen(CHECK_TRACE, "r");
+  ReflectFilter_t f;
+  unsigned int value;
+  uint8_t raw[3] = {0, 0, 0}, out[3] = {0, 0, 0};  // newest first
+  uint32_t frames = 0, rawChanges = 0, outChanges = 0, rawBlips = 0, outBlips = 0;
+  if(in == 0){
+    Check(0, "filter trace " CHECK_TRACE " opens");
+    return;
+  }
+  Filter_Init(&f);
+  while(fscanf(in, " %x", &value) == 1){
+    raw[2] = raw[1]; raw[1] = raw[0]; raw[0] = value;
+    out[2] = out[1]; out[1] = out[0]; out[0] = Filter_Majority(&f, value);
+    frames++;
+    if(frames < 3) continue;
+    rawChanges += (raw[0] != raw[1]);
+    outChanges += (out[0] != out[1]);
+    rawBlips += (raw[1] != raw[0]) && (raw[1] != raw[2]);
+    outBlips += (out[1] != out[0]) && (out[1] != out[2]);
+  }
+  fclose(in);
+  Check(frames == 2000, "filter trace has 2000 frames");
+#if REFLECT_FILTER > 1
+  Check(outBlips*10 <= rawBlips, "filter votes out nine blips in ten");
+  Check(outChanges < rawChanges, "filter cuts the pattern changes");
+#else
+  Check(outBlips == rawBlips, "filter of 1 passes the frames through");
+#endif
+}
+
+// Put a table in the flash as MotorCal_Run leaves it
+static void MotorCal_Store(MotorCal_t *c){
+  const uint32_t *p = (const uint32_t *)c;
+  uint32_t i;
+  c->magic = MOTORCAL_MAGIC;
+  c->check = 0;
+  for(i = 0; i < (sizeof(MotorCal_t)/4) - 1; i++){
+    c->check += p[i];
+  }
+  Flash_Erase();
+  Flash_Write(p, sizeof(MotorCal_t)/4);
+}
+
+// A table that does not turn until the third point, then 70 mm/s
+// a point: the inverse lands on the points, halfway between
+// them, at full duty past the top and mirrored backward.  A table
+// of zeros is refused, and so is a sweep with the wheels still.
+static void Check_MotorCal(void){
+  MotorCal_t c;
+  int32_t step = MOTOR_DUTY_FULL/(MOTORCAL_POINTS - 1);
+  uint32_t w, i;
+  for(w = 0; w < 2; w++){
+    for(i = 0; i < MOTORCAL_POINTS; i++){
+      c.speed[w][i] = (i < 2) ? 0 : (i - 1)*70;
+    }
+  }
+  MotorCal_Store(&c);
+  Check(MotorCal_Init() == 1, "motorcal takes a plausible table");
+  Check(MotorCal_Duty(TACH_LEFT, 280) == 5*step, "motorcal inverse lands on a point");
+  Check(MotorCal_Duty(TACH_RIGHT, 315) == 5*step + step/2, "motorcal inverse interpolates between points");
+  Check(MotorCal_Duty(TACH_LEFT, 1) > step, "motorcal inverse starts past the dead-band");
+  Check(MotorCal_Duty(TACH_LEFT, 1000) == MOTOR_DUTY_FULL, "motorcal inverse is full duty past the top");
+  Check(MotorCal_Duty(TACH_RIGHT, -280) == -5*step, "motorcal inverse mirrors backward");
+  Check(MotorCal_Duty(TACH_LEFT, 0) == 0, "motorcal inverse of 0 is 0");
+  Check(MotorCal_Run(&c) == 2, "motorcal run refuses a sweep with the wheels still");
+  Check(MotorCal_Init() == 1, "motorcal run keeps the table in flash");
+  for(w = 0; w < 2; w++){
+    for(i = 0; i < MOTORCAL_POINTS; i++){
+      c.speed[w][i] = 0;
+    }
+  }
+  MotorCal_Store(&c);
+  Check(MotorCal_Init() == 0, "motorcal refuses a table of zeros");
+  Check(MotorCal_Duty(TACH_LEFT, 500) == (500*MOTOR_DUTY_FULL)/ODOMETRY_FULL_SPEED,
+        "motorcal falls back to proportional without a table");
+}
+
+int main(void){
+  static SimJob_t job;                  // no parameter set, the #defines hold
+  static Sim_t sim;
+  sim.job = &job;
+  Sim = &sim;
+  Check_Governor();
+  Check_Lap();
+  Check_History();
+  Check_Filter();
+  Check_MotorCal();
+  if(Failed){
+    return 1;
+  }
+  printf("checks passed\n");
+  return 0;
+}
@@ -0,0 +1,250 @@
+// farm.c
+// Runs on the host, not the robot
+// Runs the firmware on many simulated robots at once and sums up
+// lap times and failures per parameter set and course.
+//   farm [-j threads] [-s seeds] [-l laps] [-c course,...] [-t] [sets.txt]
+// Every parameter set of sets.txt (see Param.h; without it, the
+// firmware as built) runs on every course with seeds 1 to seeds,
+// which pick the wheel errors, start pose and sensor glitches.
+//   -j  worker threads, default one per core
+//   -s  runs per set and course, default 100
+//   -l  laps per run, default 3, at most 2 on a maze
+//   -c  courses, built in or course files, default oval,rect
+//   -t  also print the latency histograms of Trace.h, summed over
+//       the runs, one line per interval as the robot sends them:
+//       name worst us: count per bin (<1us, 1us, 2-3us, 4-7us, ...)
+//       The simulated clock steps a tick, 1 ms, at a time.
+// farm runs line courses, farm-maze the same on maze courses with
+// the firmware built for them.
+// Exits 1 if any run did not finish, so make suite fails on a
+// course the firmware no longer gets round.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "Sim.h"
+#include "Pool.h"
+
+#define FARM_MAX_SETS 256
+#define FARM_MAX_COURSES 16
+
+// kind of course the firmware linked in runs, see the Makefile
+#ifndef FARM_KIND
+#define FARM_KIND COURSE_KIND_LINE
+#endif
+#if FARM_KIND == COURSE_KIND_LINE
+#define FARM_COURSES "oval,rect"
+#else
+#define FARM_COURSES ""           // none built in, -c is needed
+#endif
+
+typedef struct {
+  Param_t *set;
+  uint32_t sets;
+  Course_t *course[FARM_MAX_COURSES];
+  uint32_t courses;
+  uint32_t seeds;
+  uint32_t laps;
+  SimResult_t *result;            // [set][course][seed]
+} Farm_t;
+
+static void Farm_Job(void *arg, uint32_t i){
+  Farm_t *f = arg;
+  SimJob_t job;
+  job.param = &f->set[i/(f->courses*f->seeds)];
+  job.course = f->course[(i/f->seeds)%f->courses];
+  job.seed = i%f->seeds + 1;
+  job.laps = f->laps;
+  job.limitMs = 30000*(f->laps + 1);
+  job.built = 0;
+  Sim_Run(&job, &f->result[i]);
+}
+
+static int Farm_Sets(Farm_t *f, const char *file){
+  char line[4096];
+  uint32_t n = 0;
+  int r;
+  FILE *in = fopen(file, "r");
+  if(in == 0){
+    perror(file);
+    return -1;
+  }
+  while(fgets(line, sizeof(line), in)){
+    n++;
+    if(f->sets == FARM_MAX_SETS){
+      fprintf(stderr, "%s:%u: more than %u sets\n", file, n, FARM_MAX_SETS);
+      fclose(in);
+      return -1;
+    }
+    r = Param_Parse(&f->set[f->sets], line);
+    if(r < 0){
+      fprintf(stderr, "%s:%u: bad key or value %s\n", file, n, f->set[f->sets].name);
+      fclose(in);
+      return -1;
+    }
+    if(r == 0){
+      f->sets++;
+    }
+  }
+  fclose(in);
+  return 0;
+}
+
+static int Farm_Courses(Farm_t *f, char *list){
+  char *name;
+  for(name = strtok(list, ","); name; name = strtok(0, ",")){
+    if(f->courses == FARM_MAX_COURSES){
+      fprintf(stderr, "more than %u courses\n", FARM_MAX_COURSES);
+      return -1;
+    }
+    f->course[f->courses] = Course_Open(name);
+    if(f->course[f->courses] == 0){
+      return -1;
+    }
+    if(f->course[f->courses++]->kind != FARM_KIND){
+      fprintf(stderr, "%s: a %s course, run it with %s\n", name,
+              (FARM_KIND == COURSE_KIND_LINE) ? "maze" : "line",
+              (FARM_KIND == COURSE_KIND_LINE) ? "farm-maze" : "farm");
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// the latency histograms of each set and course
+static void Farm_Latency(const Farm_t *f){
+  static const char * const name[TRACE_INTERVALS] = {"capture", "wait", "decide", "actuate", "total"};
+  uint32_t s, c, k, i, b, worst, count[TRACE_BINS];
+  for(s = 0; s < f->sets; s++){
+    for(c = 0; c < f->courses; c++){
+      const SimResult_t *r = &f->result[(s*f->courses + c)*f->seeds];
+      printf("latency %s %s\n", f->set[s].name, f->course[c]->name);
+      for(i = 0; i < TRACE_INTERVALS; i++){
+        worst = 0;
+        memset(count, 0, sizeof(count));
+        for(k = 0; k < f->seeds; k++){
+          for(b = 0; b < TRACE_BINS; b++){
+            count[b] += r[k].latency[i][b];
+          }
+          if(r[k].latencyWorst[i] > worst) worst = r[k].latencyWorst[i];
+        }
+        printf("%-8s %6u:", name[i], worst);
+        for(b = 0; b < TRACE_BINS; b++){
+          printf(" %u", count[b]);
+        }
+        printf("\n");
+      }
+    }
+  }
+}
+
+// Output: runs that did not finish
+static uint32_t Farm_Report(const Farm_t *f, double seconds){
+  static const char * const outcome[SIM_OUTCOMES] = {"done", "lost", "stop", "time", "miss"};
+  uint32_t s, c, k, l, o, totalLaps = 0, failed = 0;
+  double simulated = 0;
+  printf("%-16s %-8s %5s", "set", "course", "runs");
+  for(o = 0; o < SIM_OUTCOMES; o++){
+    printf(" %5s", outcome[o]);
+  }
+  printf(" %6s %6s %6s %6s %6s %6s\n", "laps", "mean", "sd", "best", "worst", "lost%");
+  for(s = 0; s < f->sets; s++){
+    for(c = 0; c < f->courses; c++){
+      const SimResult_t *r = &f->result[(s*f->courses + c)*f->seeds];
+      uint32_t count[SIM_OUTCOMES] = {0}, laps = 0, best = 0, worst = 0;
+      uint64_t frames = 0, lost = 0;
+      double sum = 0, sum2 = 0, mean = 0, sd = 0;
+      for(k = 0; k < f->seeds; k++){
+        count[r[k].outcome]++;
+        frames += r[k].frames;
+        lost += r[k].lostFrames;
+        simulated += r[k].ms/1000.0;
+        for(l = 0; l < r[k].laps; l++){
+          uint32_t ms = r[k].lapMs[l];
+          laps++;
+          sum += ms;
+          sum2 += (double)ms*ms;
+          if((best == 0) || (ms < best)) best = ms;
+          if(ms > worst) worst = ms;
+        }
+      }
+      if(laps){
+        mean = sum/laps;
+        sd = (laps > 1) ? sqrt((sum2 - sum*mean)/(laps - 1)) : 0;
+      }
+      totalLaps += laps;
+      failed += f->seeds - count[SIM_FINISHED];
+      printf("%-16s %-8s %5u", f->set[s].name, f->course[c]->name, f->seeds);
+      for(o = 0; o < SIM_OUTCOMES; o++){
+        printf(" %5u", count[o]);
+      }
+      printf(" %6u %6.0f %6.0f %6u %6u %6.2f\n", laps, mean, sd, best, worst,
+             frames ? (100.0*lost)/frames : 0.0);
+    }
+  }
+  printf("%u runs, %u laps, %.0f s simulated in %.2f s, %.0f laps/min\n",
+         f->sets*f->courses*f->seeds, totalLaps, simulated, seconds,
+         seconds > 0 ? (60*totalLaps)/seconds : 0.0);
+  return failed;
+}
+
+int main(int argc, char **argv){
+  static Farm_t farm;
+  char courses[1024] = FARM_COURSES;
+  uint32_t threads = 0, jobs, c, failed, latency = 0;
+  struct timespec t0, t1;
+  int opt;
+  farm.seeds = 100;
+  farm.laps = 3;
+  farm.set = calloc(FARM_MAX_SETS, sizeof(Param_t));
+  while((opt = getopt(argc, argv, "j:s:l:c:t")) != -1){
+    switch(opt){
+      case 'j': threads = strtoul(optarg, 0, 10); break;
+      case 's': farm.seeds = strtoul(optarg, 0, 10); break;
+      case 'l': farm.laps = strtoul(optarg, 0, 10); break;
+      case 'c': snprintf(courses, sizeof(courses), "%s", optarg); break;
+      case 't': latency = 1; break;
+      default:
+        fprintf(stderr, "usage: farm [-j threads] [-s seeds] [-l laps] [-c course,...] [-t] [sets.txt]\n");
+        return 2;
+    }
+  }
+  if((farm.seeds == 0) || (farm.laps == 0) || (farm.laps > SIM_MAX_LAPS)){
+    fprintf(stderr, "seeds at least 1, laps 1 to %u\n", SIM_MAX_LAPS);
+    return 2;
+  }
+  if(optind < argc){
+    if(Farm_Sets(&farm, argv[optind])){
+      return 1;
+    }
+  }else{
+    Param_Default(&farm.set[0], "built");
+    farm.sets = 1;
+  }
+  if(Farm_Courses(&farm, courses)){
+    return 1;
+  }
+  jobs = farm.sets*farm.courses*farm.seeds;
+  farm.result = calloc(jobs, sizeof(SimResult_t));
+  if((farm.sets == 0) || (farm.result == 0)){
+    fprintf(stderr, "nothing to run\n");
+    return 1;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  Pool_Run(threads, jobs, Farm_Job, &farm);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  failed = Farm_Report(&farm, (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec)/1e9);
+  if(latency){
+    Farm_Latency(&farm);
+  }
+  for(c = 0; c < farm.courses; c++){
+    Course_Free(farm.course[c]);
+  }
+  free(farm.result);
+  free(farm.set);
+  return failed ? 1 : 0;
+}
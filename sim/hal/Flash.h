@@ -0,0 +1,19 @@
+// Flash.h
+// Runs on the host, not the robot
+// The calibration sector is an array of each run's own, erased
+// by Hal_Reset, so MotorCal finds no table unless a check has
+// written one.  Same calls as the firmware's Flash.h.
+
+#ifndef FLASH_H_
+#define FLASH_H_
+#include <stdint.h>
+
+#define FLASH_CAL_WORDS 1024      // 4 KB
+
+extern ROBOT_LOCAL uint32_t Flash_Cal[FLASH_CAL_WORDS];
+#define FLASH_CAL_ADDRESS ((uintptr_t)Flash_Cal)
+
+uint32_t Flash_Erase(void);
+uint32_t Flash_Write(const uint32_t *source, uint32_t count);
+
+#endif
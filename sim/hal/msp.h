@@ -0,0 +1,31 @@
+// msp.h
+// Runs on the host, not the robot
+// Just the registers the simulated firmware touches.  Nothing
+// raises the port 4 interrupt, so P4 is never really written.
+// Trace_Init turns on the DWT, whose counter is Sim_Clock.
+
+#ifndef MSP_H_
+#define MSP_H_
+#include <stdint.h>
+
+typedef struct {
+  volatile uint8_t IN, OUT, DIR, REN, DS, SEL0, SEL1, SELC, IES, IE, IFG;
+} DIO_PORT_Type;
+
+extern DIO_PORT_Type Sim_P4;
+#define P4 (&Sim_P4)
+
+typedef struct {
+  volatile uint32_t CTRL;
+} DWT_Type;
+
+typedef struct {
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern ROBOT_LOCAL DWT_Type Sim_DWT;
+extern ROBOT_LOCAL CoreDebug_Type Sim_CoreDebug;
+#define DWT (&Sim_DWT)
+#define CoreDebug (&Sim_CoreDebug)
+
+#endif
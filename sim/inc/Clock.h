@@ -0,0 +1,14 @@
+// Clock.h
+// Runs on the host, not the robot
+// Stand-in for the RSLK inc/Clock.h, time is the simulated ms.
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+#include <stdint.h>
+
+void Clock_Init48MHz(void);
+uint32_t Clock_GetFreq(void);
+void Clock_Delay1us(uint32_t n);
+void Clock_Delay1ms(uint32_t n);
+
+#endif
@@ -0,0 +1,16 @@
+// CortexM.h
+// Runs on the host, not the robot
+// Stand-in for the RSLK inc/CortexM.h.  The simulator runs the
+// tasks one after the other, so there is nothing to mask.
+
+#ifndef CORTEXM_H_
+#define CORTEXM_H_
+#include <stdint.h>
+
+void DisableInterrupts(void);
+void EnableInterrupts(void);
+long StartCritical(void);
+void EndCritical(long sr);
+void WaitForInterrupt(void);
+
+#endif
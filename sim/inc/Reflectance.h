@@ -0,0 +1,17 @@
+// Reflectance.h
+// Runs on the host, not the robot
+// Stand-in for the RSLK inc/Reflectance.h, the sensors read the
+// course under the simulated robot.
+
+#ifndef REFLECTANCE_H_
+#define REFLECTANCE_H_
+#include <stdint.h>
+
+void Reflectance_Init(void);
+uint8_t Reflectance_Read(uint32_t time);
+uint8_t Reflectance_Center(uint32_t time);
+int32_t Reflectance_Position(uint8_t data);
+void Reflectance_Start(void);
+uint8_t Reflectance_End(void);
+
+#endif
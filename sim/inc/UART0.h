@@ -0,0 +1,17 @@
+// UART0.h
+// Runs on the host, not the robot
+// Stand-in for the RSLK inc/UART0.h, output is dropped.
+
+#ifndef UART0_H_
+#define UART0_H_
+#include <stdint.h>
+
+void UART0_Init(void);
+char UART0_InChar(void);
+void UART0_OutChar(char data);
+void UART0_OutString(char *pt);
+void UART0_OutUDec(uint32_t n);
+void UART0_OutSDec(int32_t n);
+void UART0_OutUHex(uint32_t number);
+
+#endif
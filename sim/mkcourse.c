@@ -0,0 +1,948 @@
+// mkcourse.c
+// Runs on the host, not the robot
+// Writes a course file (see Course.h) from a drawing of the
+// course, or from a built-in course.
+//   mkcourse [-m mm] [-n name] [-k line|maze] [-s x,y,deg]
+//            [-g x0,y0,x1,y1]... drawing out.course
+// The drawing is a built-in course name, or a file:
+//   .svg  user units are mm, and the viewBox starts at 0 0.
+//         Strokes and fills other than none or white are tape,
+//         drawn with line, polyline, polygon, rect, circle and
+//         path (M L H V C S Q T A Z, circular arcs only).  Joins
+//         are round, caps follow stroke-linecap.  Styles are
+//         inherited from g, transforms are not supported.  A
+//         line of class "start" is the start, from the axle
+//         center toward the heading, lines of class "gate" are
+//         the lap markers in order, and neither is tape.  The
+//         title is the name, class "maze" on the svg a maze.
+//   .png  8 or 16 bit, or fewer for grey and palette, not
+//   .pgm  interlaced.  Dark pixels are tape, the darkness is
+//         kept as it is, and transparent is white.  One pixel
+//         is -m mm.
+//   -m  mm per pixel of the course, default COURSE_MM_PER_PIXEL
+//   -n  name, default the title or the file name
+//   -k  kind, default line, or as the svg says
+//   -s  start, axle center in mm and heading in degrees, 0 along
+//       +x and clockwise positive since y is down
+//   -g  a lap marker in mm, the first end on the robot's left;
+//       given once per marker, in order
+// Options override what the drawing says.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "Course.h"
+
+#define PI 3.14159265358979323846
+#define MK_MAX_ATTRS 32
+#define MK_MAX_DEPTH 16           // nested g
+#define MK_MAX_POINTS 4096        // in one polygon or subpath fill
+#define MK_CURVE_STEPS 16         // segments per Bezier curve
+#define MK_ARC_STEP (PI/36)       // rad per fill segment of an arc
+
+typedef struct {
+  const char *name, *value;       // into the file, not terminated
+  int nameLen, valueLen;
+} Attr_t;
+
+typedef struct {
+  const char *tag;
+  int tagLen;
+  int attrs;
+  Attr_t attr[MK_MAX_ATTRS];
+} Elem_t;
+
+typedef struct {
+  Course_t *course;
+  Elem_t group[MK_MAX_DEPTH];     // g elements around the current one
+  int depth;
+  const Elem_t *elem;             // element being drawn
+  double width;                   // stroke width, mm, 0 for no stroke
+  int cap;                        // 0 butt, 1 square, 2 round
+  int fill;                       // 1 to fill
+  double fillXY[2*MK_MAX_POINTS]; // current subpath, for the fill
+  uint32_t fillN;
+  double startX, startY;          // of the subpath, mm
+  double x, y;                    // current point
+  double firstA, lastA;           // tangent at the ends of the subpath, rad
+  int pieces;                     // drawn in the subpath
+  int started, gates;             // found class start, gate
+  double start[3];
+  double gate[COURSE_GATES][4];
+  char title[32];
+  int maze;
+} Svg_t;
+
+static const char *File;          // drawing being read, for messages
+
+static void Mk_Fail(const char *what){
+  fprintf(stderr, "%s: %s\n", File, what);
+  exit(1);
+}
+
+static char *Mk_Read(const char *path, size_t *size){
+  FILE *in = fopen(path, "rb");
+  char *data;
+  long n;
+  if((in == 0) || fseek(in, 0, SEEK_END) || ((n = ftell(in)) < 0) || fseek(in, 0, SEEK_SET)){
+    perror(path);
+    exit(1);
+  }
+  data = malloc(n + 1);
+  if((data == 0) || (fread(data, 1, n, in) != (size_t)n)){
+    perror(path);
+    exit(1);
+  }
+  data[n] = 0;
+  fclose(in);
+  *size = n;
+  return data;
+}
+
+//------------SVG------------
+
+// attribute of an element, or property of its style, terminated in buf
+static const char *Svg_Own(const Elem_t *e, const char *name, char *buf, size_t size){
+  int i, n = strlen(name);
+  for(i = 0; i < e->attrs; i++){
+    const Attr_t *a = &e->attr[i];
+    if((a->nameLen == n) && (strncmp(a->name, name, n) == 0)){
+      if((size_t)a->valueLen >= size){
+        Mk_Fail("attribute too long");
+      }
+      snprintf(buf, size, "%.*s", a->valueLen, a->value);
+      return buf;
+    }
+  }
+  for(i = 0; i < e->attrs; i++){
+    const Attr_t *a = &e->attr[i];
+    const char *p, *end = a->value + a->valueLen;
+    if((a->nameLen != 5) || strncmp(a->name, "style", 5)){
+      continue;
+    }
+    for(p = a->value; p < end; p++){
+      const char *colon, *semi;
+      while((p < end) && (isspace((unsigned char)*p) || (*p == ';'))) p++;
+      for(colon = p; (colon < end) && (*colon != ':'); colon++){}
+      for(semi = colon; (semi < end) && (*semi != ';'); semi++){}
+      if((colon < end) && (colon - p == n) && (strncmp(p, name, n) == 0)){
+        for(colon++; (colon < semi) && isspace((unsigned char)*colon); colon++){}
+        snprintf(buf, size, "%.*s", (int)(semi - colon), colon);
+        return buf;
+      }
+      p = semi;
+    }
+  }
+  return 0;
+}
+
+// the element's own value, or else the nearest group's
+static const char *Svg_Get(const Svg_t *s, const char *name, char *buf, size_t size){
+  int d;
+  if(Svg_Own(s->elem, name, buf, size)){
+    return buf;
+  }
+  for(d = s->depth - 1; d >= 0; d--){
+    if(Svg_Own(&s->group[d], name, buf, size)){
+      return buf;
+    }
+  }
+  return 0;
+}
+
+static double Svg_Number(const Svg_t *s, const char *name, double otherwise){
+  char buf[64];
+  return Svg_Own(s->elem, name, buf, sizeof(buf)) ? strtod(buf, 0) : otherwise;
+}
+
+// 1 if a paint value is tape
+static int Svg_Dark(const char *paint){
+  unsigned v, r, g, b;
+  size_t n;
+  if((paint == 0) || (strcmp(paint, "none") == 0) || (strcmp(paint, "transparent") == 0) ||
+     (strcasecmp(paint, "white") == 0)){
+    return 0;
+  }
+  n = strlen(paint);
+  if((paint[0] == '#') && (sscanf(paint + 1, "%x", &v) == 1) && ((n == 4) || (n == 7))){
+    if(n == 4){
+      r = 17*((v >> 8)&15); g = 17*((v >> 4)&15); b = 17*(v&15);
+    }else{
+      r = (v >> 16)&255; g = (v >> 8)&255; b = v&255;
+    }
+    return 299*r + 587*g + 114*b < 128*1000;
+  }
+  return 1;                       // any other colour is tape
+}
+
+// 1 if the element's class list has the word
+static int Svg_Class(const Elem_t *e, const char *word){
+  char buf[256], *w, *save;
+  if(Svg_Own(e, "class", buf, sizeof(buf)) == 0){
+    return 0;
+  }
+  for(w = strtok_r(buf, " \t\n", &save); w; w = strtok_r(0, " \t\n", &save)){
+    if(strcmp(w, word) == 0){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// stroke and fill of the element
+static void Svg_Paint(Svg_t *s){
+  char buf[64];
+  const char *fill = Svg_Get(s, "fill", buf, sizeof(buf));
+  s->fill = fill ? Svg_Dark(fill) : 1;   // SVG fills black unless told not to
+  s->width = 0;
+  if(Svg_Dark(Svg_Get(s, "stroke", buf, sizeof(buf)))){
+    s->width = Svg_Get(s, "stroke-width", buf, sizeof(buf)) ? strtod(buf, 0) : 1;
+  }
+  s->cap = 0;
+  if(Svg_Get(s, "stroke-linecap", buf, sizeof(buf))){
+    s->cap = (strcmp(buf, "square") == 0) ? 1 : (strcmp(buf, "round") == 0) ? 2 : 0;
+  }
+}
+
+// the end of a stroke at (x,y), tangent a pointing out of it
+static void Svg_Cap(Svg_t *s, double x, double y, double a){
+  if(s->cap == 1){
+    Raster_Box(s->course, x + cos(a)*s->width/4, y + sin(a)*s->width/4, a, s->width/2, s->width);
+  }else if(s->cap == 2){
+    Raster_Disc(s->course, x, y, s->width/2);
+  }
+}
+
+static void Svg_FillPoint(Svg_t *s, double x, double y){
+  if(s->fillN == MK_MAX_POINTS){
+    Mk_Fail("too many points in one filled shape");
+  }
+  s->fillXY[2*s->fillN] = x;
+  s->fillXY[2*s->fillN + 1] = y;
+  s->fillN++;
+}
+
+static void Svg_MoveTo(Svg_t *s, double x, double y){
+  s->startX = s->x = x;
+  s->startY = s->y = y;
+  s->pieces = 0;
+  s->fillN = 0;
+  Svg_FillPoint(s, x, y);
+}
+
+// a straight piece from the current point, a0 and a1 the tangents
+// it leaves and arrives with
+static void Svg_Piece(Svg_t *s, double a0, double a1){
+  if(s->width > 0){
+    if(s->pieces > 0){
+      Raster_Disc(s->course, s->x, s->y, s->width/2);   // round join
+    }else{
+      s->firstA = a0;
+    }
+  }
+  s->lastA = a1;
+  s->pieces++;
+}
+
+static void Svg_LineTo(Svg_t *s, double x, double y){
+  double a = atan2(y - s->y, x - s->x);
+  if((x == s->x) && (y == s->y)){
+    return;
+  }
+  Svg_Piece(s, a, a);
+  if(s->width > 0){
+    Raster_Line(s->course, s->x, s->y, x, y, s->width);
+  }
+  s->x = x;
+  s->y = y;
+  Svg_FillPoint(s, x, y);
+}
+
+// circular arc to (x,y), endpoint form of SVG
+static void Svg_ArcTo(Svg_t *s, double r, int large, int sweep, double x, double y){
+  double hx = (s->x - x)/2, hy = (s->y - y)/2, d = hypot(hx, hy), h, cx, cy, a0, a1, t0, t1, a;
+  if(d == 0){
+    return;
+  }
+  if(r < d) r = d;
+  h = sqrt(r*r - d*d)/d*((large != sweep) ? 1 : -1);
+  cx = (s->x + x)/2 + h*hy;
+  cy = (s->y + y)/2 - h*hx;
+  t0 = atan2(s->y - cy, s->x - cx);
+  t1 = atan2(y - cy, x - cx);
+  if(sweep){                      // clockwise on the page, angles increase
+    while(t1 <= t0) t1 += 2*PI;
+    Svg_Piece(s, t0 + PI/2, t1 + PI/2);
+    for(a = t0 + MK_ARC_STEP; a < t1; a += MK_ARC_STEP){
+      Svg_FillPoint(s, cx + r*cos(a), cy + r*sin(a));
+    }
+    a0 = t0;
+    a1 = t1;
+  }else{
+    while(t0 <= t1) t0 += 2*PI;
+    Svg_Piece(s, t0 - PI/2, t1 - PI/2);
+    for(a = t0 - MK_ARC_STEP; a > t1; a -= MK_ARC_STEP){
+      Svg_FillPoint(s, cx + r*cos(a), cy + r*sin(a));
+    }
+    a0 = atan2(y - cy, x - cx);   // Raster_Arc runs clockwise, from the end
+    a1 = a0 + (t0 - t1);
+  }
+  if(s->width > 0){
+    Raster_Arc(s->course, cx, cy, r, a0, a1, s->width);
+  }
+  s->x = x;
+  s->y = y;
+  Svg_FillPoint(s, x, y);
+}
+
+// cubic Bezier, in straight pieces
+static void Svg_CurveTo(Svg_t *s, double x1, double y1, double x2, double y2, double x, double y){
+  double x0 = s->x, y0 = s->y;
+  int i;
+  for(i = 1; i <= MK_CURVE_STEPS; i++){
+    double t = (double)i/MK_CURVE_STEPS, u = 1 - t;
+    Svg_LineTo(s, u*u*u*x0 + 3*u*u*t*x1 + 3*u*t*t*x2 + t*t*t*x,
+                  u*u*u*y0 + 3*u*u*t*y1 + 3*u*t*t*y2 + t*t*t*y);
+  }
+}
+
+// the end of a subpath
+static void Svg_End(Svg_t *s, int closed){
+  if(closed){
+    Svg_LineTo(s, s->startX, s->startY);
+    if((s->width > 0) && s->pieces){
+      Raster_Disc(s->course, s->x, s->y, s->width/2);
+    }
+  }else if((s->width > 0) && s->pieces){
+    Svg_Cap(s, s->startX, s->startY, s->firstA + PI);
+    Svg_Cap(s, s->x, s->y, s->lastA);
+  }
+  if(s->fill){
+    Raster_Polygon(s->course, s->fillXY, s->fillN);
+  }
+  s->pieces = 0;
+  s->fillN = 0;
+}
+
+// next number of a path or points list, 0 if there is none
+static int Svg_Next(const char **p, double *v){
+  char *end;
+  while(isspace((unsigned char)**p) || (**p == ',')) (*p)++;
+  *v = strtod(*p, &end);
+  if(end == *p){
+    return 0;
+  }
+  *p = end;
+  return 1;
+}
+
+// next arc flag, which need not be followed by a separator
+static int Svg_Flag(const char **p, int *f){
+  while(isspace((unsigned char)**p) || (**p == ',')) (*p)++;
+  if((**p != '0') && (**p != '1')){
+    return 0;
+  }
+  *f = *(*p)++ - '0';
+  return 1;
+}
+
+static void Svg_Path(Svg_t *s, const char *d){
+  char cmd = 0;
+  double v[6], cx = 0, cy = 0;    // last control point, for S and T
+  char last = 0;
+  int large, sweep, open = 0;
+  const char *p = d;
+  for(;;){
+    int i, n, rel;
+    while(isspace((unsigned char)*p) || (*p == ',')) p++;
+    if(*p == 0){
+      break;
+    }
+    if(isalpha((unsigned char)*p)){
+      cmd = *p++;
+    }else if(cmd == 0){
+      Mk_Fail("path data does not start with a command");
+    }
+    rel = islower((unsigned char)cmd);
+    switch(toupper((unsigned char)cmd)){
+      case 'Z':
+        if(open){
+          Svg_End(s, 1);
+          Svg_MoveTo(s, s->startX, s->startY);   // where a path going on starts
+        }
+        last = 'Z';
+        continue;
+      case 'M': case 'L': case 'T': n = 2; break;
+      case 'H': case 'V': n = 1; break;
+      case 'S': case 'Q': n = 4; break;
+      case 'C': n = 6; break;
+      case 'A': n = 7; break;
+      default: Mk_Fail("path command not supported"); return;
+    }
+    if(toupper((unsigned char)cmd) == 'A'){
+      if(!Svg_Next(&p, &v[0]) || !Svg_Next(&p, &v[1]) || !Svg_Next(&p, &v[2]) ||
+         !Svg_Flag(&p, &large) || !Svg_Flag(&p, &sweep) || !Svg_Next(&p, &v[3]) || !Svg_Next(&p, &v[4])){
+        Mk_Fail("bad arc in path data");
+      }
+      if(fabs(v[0] - v[1]) > 1e-6*fabs(v[0])){
+        Mk_Fail("elliptical arcs are not supported");
+      }
+      Svg_ArcTo(s, fabs(v[0]), large, sweep, v[3] + (rel ? s->x : 0), v[4] + (rel ? s->y : 0));
+      last = 'A';
+      continue;
+    }
+    for(i = 0; i < n; i++){
+      if(!Svg_Next(&p, &v[i])){
+        Mk_Fail("bad numbers in path data");
+      }
+      if(rel && (n > 1)){
+        v[i] += (i&1) ? s->y : s->x;
+      }
+    }
+    switch(toupper((unsigned char)cmd)){
+      case 'M':
+        if(open){
+          Svg_End(s, 0);
+        }
+        Svg_MoveTo(s, v[0], v[1]);
+        open = 1;
+        cmd = rel ? 'l' : 'L';    // pairs after a move are lines
+        break;
+      case 'L':
+        Svg_LineTo(s, v[0], v[1]);
+        break;
+      case 'H':
+        Svg_LineTo(s, v[0] + (rel ? s->x : 0), s->y);
+        break;
+      case 'V':
+        Svg_LineTo(s, s->x, v[0] + (rel ? s->y : 0));
+        break;
+      case 'C':
+        Svg_CurveTo(s, v[0], v[1], v[2], v[3], v[4], v[5]);
+        cx = v[2]; cy = v[3];
+        break;
+      case 'S':
+        if((last != 'C') && (last != 'S')){ cx = s->x; cy = s->y; }
+        Svg_CurveTo(s, 2*s->x - cx, 2*s->y - cy, v[0], v[1], v[2], v[3]);
+        cx = v[0]; cy = v[1];
+        break;
+      case 'Q': case 'T':         // control point in v[0], the end in v[2]
+        if(toupper((unsigned char)cmd) == 'T'){
+          if((last != 'Q') && (last != 'T')){ cx = s->x; cy = s->y; }
+          v[2] = v[0]; v[3] = v[1];
+          v[0] = 2*s->x - cx; v[1] = 2*s->y - cy;
+        }
+        Svg_CurveTo(s, s->x + 2*(v[0] - s->x)/3, s->y + 2*(v[1] - s->y)/3,
+                       v[2] + 2*(v[0] - v[2])/3, v[3] + 2*(v[1] - v[3])/3, v[2], v[3]);
+        cx = v[0]; cy = v[1];
+        break;
+    }
+    last = toupper((unsigned char)cmd);
+  }
+  if(open){
+    Svg_End(s, 0);
+  }
+}
+
+static void Svg_Points(Svg_t *s, const char *p, int closed){
+  double x, y;
+  int first = 1;
+  while(Svg_Next(&p, &x) && Svg_Next(&p, &y)){
+    if(first){
+      Svg_MoveTo(s, x, y);
+      first = 0;
+    }else{
+      Svg_LineTo(s, x, y);
+    }
+  }
+  if(!first){
+    Svg_End(s, closed);
+  }
+}
+
+// a start or gate line, not tape
+static int Svg_Marker(Svg_t *s){
+  double x1 = Svg_Number(s, "x1", 0), y1 = Svg_Number(s, "y1", 0);
+  double x2 = Svg_Number(s, "x2", 0), y2 = Svg_Number(s, "y2", 0);
+  if(Svg_Class(s->elem, "start")){
+    s->start[0] = x1;
+    s->start[1] = y1;
+    s->start[2] = atan2(y2 - y1, x2 - x1);
+    s->started = 1;
+    return 1;
+  }
+  if(Svg_Class(s->elem, "gate")){
+    if(s->gates == COURSE_GATES){
+      Mk_Fail("too many lap markers");
+    }
+    s->gate[s->gates][0] = x1;
+    s->gate[s->gates][1] = y1;
+    s->gate[s->gates][2] = x2;
+    s->gate[s->gates][3] = y2;
+    s->gates++;
+    return 1;
+  }
+  return 0;
+}
+
+static void Svg_Draw(Svg_t *s){
+  const Elem_t *e = s->elem;
+  static char buf[1 << 20];
+  if(Svg_Own(e, "transform", buf, sizeof(buf))){
+    Mk_Fail("transforms are not supported, flatten the drawing");
+  }
+  Svg_Paint(s);
+  if((e->tagLen == 4) && (strncmp(e->tag, "line", 4) == 0)){
+    if(Svg_Marker(s) == 0){
+      s->fill = 0;
+      Svg_MoveTo(s, Svg_Number(s, "x1", 0), Svg_Number(s, "y1", 0));
+      Svg_LineTo(s, Svg_Number(s, "x2", 0), Svg_Number(s, "y2", 0));
+      Svg_End(s, 0);
+    }
+  }else if((e->tagLen == 4) && (strncmp(e->tag, "rect", 4) == 0)){
+    double x = Svg_Number(s, "x", 0), y = Svg_Number(s, "y", 0);
+    double w = Svg_Number(s, "width", 0), h = Svg_Number(s, "height", 0);
+    Svg_MoveTo(s, x, y);
+    Svg_LineTo(s, x + w, y);
+    Svg_LineTo(s, x + w, y + h);
+    Svg_LineTo(s, x, y + h);
+    Svg_End(s, 1);
+  }else if((e->tagLen == 6) && (strncmp(e->tag, "circle", 6) == 0)){
+    double x = Svg_Number(s, "cx", 0), y = Svg_Number(s, "cy", 0), r = Svg_Number(s, "r", 0);
+    if(s->fill){
+      Raster_Disc(s->course, x, y, r);
+    }
+    if(s->width > 0){
+      Raster_Arc(s->course, x, y, r, -PI, PI, s->width);
+    }
+  }else if((e->tagLen == 8) && (strncmp(e->tag, "polyline", 8) == 0)){
+    Svg_Points(s, Svg_Own(e, "points", buf, sizeof(buf)) ? buf : "", 0);
+  }else if((e->tagLen == 7) && (strncmp(e->tag, "polygon", 7) == 0)){
+    Svg_Points(s, Svg_Own(e, "points", buf, sizeof(buf)) ? buf : "", 1);
+  }else if((e->tagLen == 4) && (strncmp(e->tag, "path", 4) == 0)){
+    Svg_Path(s, Svg_Own(e, "d", buf, sizeof(buf)) ? buf : "");
+  }
+}
+
+// parse the tag at p, just past '<'
+// Output: past its '>', 0 on a syntax error
+static const char *Svg_Tag(const char *p, Elem_t *e, int *close, int *empty){
+  *close = (*p == '/');
+  p += *close;
+  e->tag = p;
+  while(*p && !isspace((unsigned char)*p) && (*p != '>') && (*p != '/')) p++;
+  e->tagLen = p - e->tag;
+  e->attrs = 0;
+  for(;;){
+    while(isspace((unsigned char)*p)) p++;
+    if(*p == '>'){
+      *empty = 0;
+      return p + 1;
+    }
+    if((p[0] == '/') && (p[1] == '>')){
+      *empty = 1;
+      return p + 2;
+    }
+    if(*p == 0){
+      return 0;
+    }
+    if(e->attrs < MK_MAX_ATTRS){
+      Attr_t *a = &e->attr[e->attrs++];
+      char quote;
+      a->name = p;
+      while(*p && (*p != '=') && !isspace((unsigned char)*p)) p++;
+      a->nameLen = p - a->name;
+      while(isspace((unsigned char)*p) || (*p == '=')) p++;
+      if((*p != '"') && (*p != '\'')){
+        return 0;
+      }
+      quote = *p++;
+      a->value = p;
+      while(*p && (*p != quote)) p++;
+      if(*p == 0){
+        return 0;
+      }
+      a->valueLen = p - a->value;
+      p++;
+    }else{
+      return 0;
+    }
+  }
+}
+
+static Course_t *Svg_Load(const char *path, double mm){
+  size_t size;
+  char *data = Mk_Read(path, &size), buf[256];
+  const char *p = data;
+  Svg_t *s = calloc(1, sizeof(Svg_t));
+  Elem_t e;
+  int close, empty;
+  double w = 0, h = 0, x0 = 0, y0 = 0;
+  uint32_t g;
+  while((p = strchr(p, '<')) != 0){
+    p++;
+    if((*p == '?') || (*p == '!')){   // declaration or comment
+      const char *end = strstr(p, (strncmp(p, "!--", 3) == 0) ? "-->" : ">");
+      if(end == 0){
+        Mk_Fail("unterminated comment");
+      }
+      p = end + 1;
+      continue;
+    }
+    p = Svg_Tag(p, &e, &close, &empty);
+    if(p == 0){
+      Mk_Fail("bad tag");
+    }
+    if(close){
+      if((e.tagLen == 1) && (e.tag[0] == 'g') && (s->depth > 0)){
+        s->depth--;
+      }
+      continue;
+    }
+    s->elem = &e;
+    if((e.tagLen == 3) && (strncmp(e.tag, "svg", 3) == 0)){
+      if(Svg_Own(&e, "viewBox", buf, sizeof(buf))){
+        if(sscanf(buf, "%lf%*[ ,]%lf%*[ ,]%lf%*[ ,]%lf", &x0, &y0, &w, &h) != 4){
+          Mk_Fail("bad viewBox");
+        }
+      }else{
+        w = Svg_Number(s, "width", 0);
+        h = Svg_Number(s, "height", 0);
+      }
+      if((x0 != 0) || (y0 != 0) || !(w > 0) || !(h > 0)){
+        Mk_Fail("the svg needs a size, and a viewBox from 0 0");
+      }
+      s->maze = Svg_Class(&e, "maze");
+      s->course = Course_New("", w, h, mm);
+      if(s->course == 0){
+        Mk_Fail("out of memory");
+      }
+    }else if(s->course == 0){
+      continue;                   // nothing before the svg is drawn
+    }else if((e.tagLen == 1) && (e.tag[0] == 'g')){
+      if(Svg_Own(&e, "transform", buf, sizeof(buf))){
+        Mk_Fail("transforms are not supported, flatten the drawing");
+      }
+      if(!empty){
+        if(s->depth == MK_MAX_DEPTH){
+          Mk_Fail("groups nested too deep");
+        }
+        s->group[s->depth++] = e;
+      }
+    }else if((e.tagLen == 5) && (strncmp(e.tag, "title", 5) == 0)){
+      const char *end = strchr(p, '<');
+      if(end && (s->title[0] == 0)){
+        snprintf(s->title, sizeof(s->title), "%.*s", (int)(end - p), p);
+      }
+    }else{
+      Svg_Draw(s);
+    }
+  }
+  if(s->course == 0){
+    Mk_Fail("no svg element");
+  }
+  if(s->title[0]){
+    memcpy(s->course->name, s->title, sizeof(s->course->name) - 1);
+  }
+  if(s->started){
+    s->course->startX = s->start[0];
+    s->course->startY = s->start[1];
+    s->course->startHeading = s->start[2];
+  }else{
+    s->course->startX = -1;       // -s has to say
+  }
+  s->course->kind = s->maze ? COURSE_KIND_MAZE : COURSE_KIND_LINE;
+  for(g = 0; g < (uint32_t)s->gates; g++){
+    Course_Gate(s->course, s->gate[g][0], s->gate[g][1], s->gate[g][2], s->gate[g][3]);
+  }
+  {
+    Course_t *c = s->course;
+    free(s);
+    free(data);
+    return c;
+  }
+}
+
+//------------images------------
+
+// sample i of a row of samples of the given bits, scaled to 0..255
+// unless raw
+static uint32_t Png_Sample(const uint8_t *row, uint32_t i, uint32_t bits, int raw){
+  uint32_t v;
+  if(bits == 16){
+    return row[2*i];
+  }
+  if(bits == 8){
+    return row[i];
+  }
+  v = (row[(i*bits)/8] >> (8 - bits - (i*bits)%8))&((1u << bits) - 1);
+  return raw ? v : (v*255)/((1u << bits) - 1);
+}
+
+static uint32_t Png_Be(const uint8_t *p){
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static int Png_Paeth(int a, int b, int c){
+  int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+  return ((pa <= pb) && (pa <= pc)) ? a : (pb <= pc) ? b : c;
+}
+
+// darkness of every pixel, row by row, 0 white
+static uint8_t *Png_Load(const char *path, uint32_t *width, uint32_t *height){
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  static const uint32_t channels[7] = {1, 0, 3, 1, 2, 0, 4};
+  size_t size, at, idat = 0;
+  uint8_t *data = (uint8_t *)Mk_Read(path, &size), *z, *raw, *dark, palette[256][4];
+  uint32_t w = 0, h = 0, bits = 0, type = 0, ch, stride, bpp, x, y, i;
+  uLongf rawSize;
+  memset(palette, 255, sizeof(palette));
+  if((size < 8) || memcmp(data, signature, 8)){
+    Mk_Fail("not a PNG");
+  }
+  z = malloc(size);
+  for(at = 8; at + 12 <= size; ){
+    uint32_t n = Png_Be(&data[at]);
+    const uint8_t *t = &data[at + 4], *d = &data[at + 8];
+    if(n > size - at - 12){
+      Mk_Fail("truncated PNG");
+    }
+    if(memcmp(t, "IHDR", 4) == 0){
+      w = Png_Be(d);
+      h = Png_Be(d + 4);
+      bits = d[8];
+      type = d[9];
+      if(d[12]){
+        Mk_Fail("interlaced PNG is not supported");
+      }
+    }else if(memcmp(t, "PLTE", 4) == 0){
+      for(i = 0; (i < 256) && (3*i + 2 < n); i++){
+        memcpy(palette[i], &d[3*i], 3);
+      }
+    }else if((memcmp(t, "tRNS", 4) == 0) && (type == 3)){
+      for(i = 0; (i < 256) && (i < n); i++){
+        palette[i][3] = d[i];
+      }
+    }else if(memcmp(t, "IDAT", 4) == 0){
+      memcpy(&z[idat], d, n);
+      idat += n;
+    }else if(memcmp(t, "IEND", 4) == 0){
+      break;
+    }
+    at += n + 12;
+  }
+  if((w == 0) || (h == 0) || (type > 6) || (channels[type] == 0) ||
+     ((bits != 8) && (bits != 16) && !(((type == 0) || (type == 3)) && (bits < 8)))){
+    Mk_Fail("PNG of a kind not supported");
+  }
+  ch = channels[type];
+  stride = (w*ch*bits + 7)/8;
+  bpp = (ch*bits + 7)/8;
+  rawSize = (uLongf)(stride + 1)*h;
+  raw = malloc(rawSize);
+  if((raw == 0) || (uncompress(raw, &rawSize, z, idat) != Z_OK) || (rawSize != (uLongf)(stride + 1)*h)){
+    Mk_Fail("bad PNG data");
+  }
+  for(y = 0; y < h; y++){         // undo the filters, in place
+    uint8_t *r = &raw[y*(stride + 1) + 1], *up = y ? r - (stride + 1) : 0;
+    for(x = 0; x < stride; x++){
+      int a = (x >= bpp) ? r[x - bpp] : 0, b = up ? up[x] : 0, c = (up && (x >= bpp)) ? up[x - bpp] : 0;
+      switch(r[-1]){
+        case 1: r[x] += a; break;
+        case 2: r[x] += b; break;
+        case 3: r[x] += (a + b)/2; break;
+        case 4: r[x] += Png_Paeth(a, b, c); break;
+      }
+    }
+  }
+  dark = malloc((size_t)w*h);
+  for(y = 0; y < h; y++){
+    const uint8_t *r = &raw[y*(stride + 1) + 1];
+    for(x = 0; x < w; x++){
+      uint32_t grey, alpha = 255;
+      if(type == 3){
+        const uint8_t *c = palette[Png_Sample(r, x, bits, 1)];
+        grey = (299*c[0] + 587*c[1] + 114*c[2])/1000;
+        alpha = c[3];
+      }else if(ch >= 3){
+        grey = (299*Png_Sample(r, x*ch, bits, 0) + 587*Png_Sample(r, x*ch + 1, bits, 0) +
+                114*Png_Sample(r, x*ch + 2, bits, 0))/1000;
+      }else{
+        grey = Png_Sample(r, x*ch, bits, 0);
+      }
+      if((ch == 2) || (ch == 4)){
+        alpha = Png_Sample(r, x*ch + ch - 1, bits, 0);
+      }
+      dark[(size_t)y*w + x] = (255 - grey)*alpha/255;
+    }
+  }
+  free(raw);
+  free(z);
+  free(data);
+  *width = w;
+  *height = h;
+  return dark;
+}
+
+// P2 or P5
+static uint8_t *Pgm_Load(const char *path, uint32_t *width, uint32_t *height){
+  size_t size, n;
+  char *data = Mk_Read(path, &size), *p = data + 2, *end;
+  uint32_t v[3], i, max;
+  uint8_t *dark;
+  if((size < 2) || (data[0] != 'P') || ((data[1] != '2') && (data[1] != '5'))){
+    Mk_Fail("not a PGM");
+  }
+  for(i = 0; i < 3; i++){         // width, height, maxval, with comments
+    while(isspace((unsigned char)*p) || (*p == '#')){
+      if(*p == '#'){
+        p += strcspn(p, "\n");
+      }else{
+        p++;
+      }
+    }
+    v[i] = strtoul(p, &end, 10);
+    if(end == p){
+      Mk_Fail("bad PGM header");
+    }
+    p = end;
+  }
+  max = v[2];
+  n = (size_t)v[0]*v[1];
+  if((n == 0) || (max == 0) || (max > 65535)){
+    Mk_Fail("bad PGM header");
+  }
+  p++;                            // the one whitespace after maxval
+  if((data[1] == '5') && ((size_t)(p - data) + n*((max > 255) ? 2 : 1) > size)){
+    Mk_Fail("truncated PGM");
+  }
+  dark = malloc(n);
+  for(i = 0; i < n; i++){
+    uint32_t grey;
+    if(data[1] == '5'){
+      grey = (max > 255) ? ((uint8_t)p[2*i] << 8) | (uint8_t)p[2*i + 1] : (uint8_t)p[i];
+    }else{
+      grey = strtoul(p, &end, 10);
+      if(end == p){
+        Mk_Fail("truncated PGM");
+      }
+      p = end;
+    }
+    dark[i] = 255 - (grey*255)/max;
+  }
+  free(data);
+  *width = v[0];
+  *height = v[1];
+  return dark;
+}
+
+static Course_t *Image_Load(const char *path, double mm, int png){
+  uint32_t w, h, x, y;
+  uint8_t *dark = png ? Png_Load(path, &w, &h) : Pgm_Load(path, &w, &h);
+  Course_t *c = Course_New("", w*mm, h*mm, mm);
+  if(c == 0){
+    Mk_Fail("out of memory");
+  }
+  for(y = 0; y < h; y++){
+    for(x = 0; x < w; x++){
+      c->dark[Course_Pixel(c, x, y)] = dark[(size_t)y*w + x];
+    }
+  }
+  free(dark);
+  c->startX = -1;                 // -s has to say
+  return c;
+}
+
+//------------main------------
+
+static const char *Mk_Extension(const char *path){
+  const char *dot = strrchr(path, '.');
+  return (dot && (strchr(dot, '/') == 0)) ? dot + 1 : "";
+}
+
+int main(int argc, char **argv){
+  double mm = COURSE_MM_PER_PIXEL, start[3], gate[COURSE_GATES][4];
+  const char *name = "", *kind = 0, *ext;
+  int opt, started = 0, gates = 0, g;
+  Course_t *c;
+  while((opt = getopt(argc, argv, "m:n:k:s:g:")) != -1){
+    switch(opt){
+      case 'm': mm = strtod(optarg, 0); break;
+      case 'n': name = optarg; break;
+      case 'k': kind = optarg; break;
+      case 's':
+        if(sscanf(optarg, "%lf,%lf,%lf", &start[0], &start[1], &start[2]) != 3){
+          fprintf(stderr, "-s x,y,degrees\n");
+          return 2;
+        }
+        start[2] *= PI/180;
+        started = 1;
+        break;
+      case 'g':
+        if((gates == COURSE_GATES) ||
+           (sscanf(optarg, "%lf,%lf,%lf,%lf", &gate[gates][0], &gate[gates][1],
+                   &gate[gates][2], &gate[gates][3]) != 4)){
+          fprintf(stderr, "-g x0,y0,x1,y1, at most %u\n", COURSE_GATES);
+          return 2;
+        }
+        gates++;
+        break;
+      default:
+        optind = argc;
+        break;
+    }
+  }
+  if((argc - optind != 2) || !(mm > 0) ||
+     (kind && strcmp(kind, "line") && strcmp(kind, "maze"))){
+    fprintf(stderr, "usage: mkcourse [-m mm] [-n name] [-k line|maze] [-s x,y,deg]\n"
+                    "                [-g x0,y0,x1,y1]... drawing out.course\n"
+                    "drawing: .svg, .png, .pgm or built in: %s\n", Course_Names());
+    return 2;
+  }
+  File = argv[optind];
+  ext = Mk_Extension(File);
+  if(strcasecmp(ext, "svg") == 0){
+    c = Svg_Load(File, mm);
+  }else if((strcasecmp(ext, "png") == 0) || (strcasecmp(ext, "pgm") == 0)){
+    c = Image_Load(File, mm, strcasecmp(ext, "png") == 0);
+  }else if((c = Course_Make(File)) == 0){
+    Mk_Fail("not a drawing or a built-in course");
+  }
+  if(name[0]){
+    snprintf(c->name, sizeof(c->name), "%s", name);
+  }else if(c->name[0] == 0){      // the file name, for a drawing without a title
+    const char *slash = strrchr(File, '/'), *b = slash ? slash + 1 : File;
+    snprintf(c->name, sizeof(c->name), "%.*s", (int)strcspn(b, "."), b);
+  }
+  if(kind){
+    c->kind = (strcmp(kind, "maze") == 0) ? COURSE_KIND_MAZE : COURSE_KIND_LINE;
+  }
+  if(started){
+    c->startX = start[0];
+    c->startY = start[1];
+    c->startHeading = start[2];
+  }
+  if(gates){
+    c->gates = 0;
+    for(g = 0; g < gates; g++){
+      Course_Gate(c, gate[g][0], gate[g][1], gate[g][2], gate[g][3]);
+    }
+  }
+  if(!Course_Inside(c, c->startX, c->startY)){
+    Mk_Fail("no start on the course, give one with -s");
+  }
+  if(Course_Save(c, argv[optind + 1])){
+    perror(argv[optind + 1]);
+    return 1;
+  }
+  printf("%s: %s, %s, %ux%u pixels at %g mm, %u lap markers\n", argv[optind + 1], c->name,
+         (c->kind == COURSE_KIND_MAZE) ? "maze" : "line", c->width, c->height, c->mmPerPixel, c->gates);
+  Course_Free(c);
+  return 0;
+}
@@ -0,0 +1,443 @@
+// tune.c
+// Runs on the host, not the robot
+// Searches the FSM dwells, duty levels and controller constants
+// for the fastest laps, with CMA-ES over the simulator, and
+// writes the best set found as FsmTuned.h.
+//   tune [-j threads] [-s seeds] [-l laps] [-c course,...] [-g generations]
+//        [-p population] [-w ms] [-r seed] [-o FsmTuned.h] [base.txt]
+// Courses are built in or course files, line courses only.  The
+// default is the line courses of the library (see the Makefile),
+// every line course in build/courses, or the built-in courses
+// until make courses has been run.
+// Every candidate runs the same suite, each course with seeds 1
+// to seeds, and costs the mean over the runs of
+//   lap times + TUNE_MISS_MS per lap not run + w per lost frame
+// so a set that loses the line or stops pays for it.  The first
+// set of base.txt (see Param.h) gives the world and the start
+// point, by default the firmware as built.  Values the suite
+// never reads (the maze states, GAP_MM without a dashed course)
+// are not searched and are kept as built.  The best set is run
+// again on fresh seeds against the start point, and its parameter
+// line goes to stderr for farm.  The header is written only if the
+// best set costs less there too; otherwise tune exits with 1 and
+// writes nothing.
+//   -g  generations, default 40
+//   -p  population, default 4 + 3 ln(dimensions)
+//   -w  ms of cost per frame with no line, default 20
+//   -o  header to write, default stdout
+// Copy the header next to LineFollowFSMmain.c and build the
+// robot with FSM_TUNED defined.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <glob.h>
+#include "Sim.h"
+#include "Pool.h"
+#include "Cma.h"
+
+#define TUNE_MISS_MS 60000        // cost of a lap not run
+#define TUNE_CHECK_SEEDS 1000     // first seed of the final check
+#define TUNE_MAX_COURSES 16
+#define TUNE_MAX_TARGETS 12
+#define TUNE_LIBRARY "build/courses/*.course"
+#define TUNE_BUILTIN "oval,ovalccw,rect"
+
+// a dimension of the search: one value written to some fields
+#define TUNE_DUTY 0               // |duty| of the faster wheel of each target,
+                                  // the other wheel and the signs scaled as built
+#define TUNE_DWELL 1              // delay of one state
+#define TUNE_PARAM 2              // a ROBOT_PARAM constant
+typedef struct {
+  const char *name;
+  uint32_t kind;
+  double lo, hi;
+  const char *state[TUNE_MAX_TARGETS]; // TUNE_DUTY: both wheels of each
+  uint32_t param;                 // TUNE_PARAM: ROBOT_ id
+} Dim_t;
+
+static const Dim_t Dims[] = {
+  {"center duty", TUNE_DUTY, 1000, 15000, {"Center"}, 0},
+  {"slight duty", TUNE_DUTY, 1000, 15000, {"SlightLeft", "SlightRight"}, 0},
+  {"turn duty", TUNE_DUTY, 1000, 15000, {"Left", "Right"}, 0},
+  {"buffer duty", TUNE_DUTY, 1000, 15000, {"BufferCenter", "BufferCenter2", "OffCenter"}, 0},
+  {"pivot duty", TUNE_DUTY, 1000, 15000, {"OffLeft", "OffLeft2", "OffLeft3", "OffRight", "OffRight2", "OffRight3"}, 0},
+  {"sweep duty", TUNE_DUTY, 1000, 15000, {"LostRight", "LostRight2", "LostRight3", "LostRight4", "LostRight5", "LostRight6",
+                                          "LostLeft", "LostLeft2", "LostLeft3", "LostLeft4", "LostLeft5", "LostLeft6"}, 0},
+  {"reverse duty", TUNE_DUTY, 1000, 15000, {"Reverse"}, 0},
+  {"Center", TUNE_DWELL, 5, 255, {"Center"}, 0},
+  {"SlightLeft", TUNE_DWELL, 5, 255, {"SlightLeft"}, 0},
+  {"Left", TUNE_DWELL, 5, 255, {"Left"}, 0},
+  {"SlightRight", TUNE_DWELL, 5, 255, {"SlightRight"}, 0},
+  {"Right", TUNE_DWELL, 5, 255, {"Right"}, 0},
+  {"BufferCenter", TUNE_DWELL, 5, 255, {"BufferCenter"}, 0},
+  {"BufferCenter2", TUNE_DWELL, 5, 255, {"BufferCenter2"}, 0},
+  {"LostRight", TUNE_DWELL, 5, 255, {"LostRight"}, 0},
+  {"LostRight2", TUNE_DWELL, 5, 255, {"LostRight2"}, 0},
+  {"OffCenter", TUNE_DWELL, 5, 255, {"OffCenter"}, 0},
+  {"OffLeft", TUNE_DWELL, 5, 255, {"OffLeft"}, 0},
+  {"OffLeft2", TUNE_DWELL, 5, 255, {"OffLeft2"}, 0},
+  {"OffLeft3", TUNE_DWELL, 5, 255, {"OffLeft3"}, 0},
+  {"OffRight", TUNE_DWELL, 5, 255, {"OffRight"}, 0},
+  {"OffRight2", TUNE_DWELL, 5, 255, {"OffRight2"}, 0},
+  {"OffRight3", TUNE_DWELL, 5, 255, {"OffRight3"}, 0},
+  {"Reverse", TUNE_DWELL, 5, 255, {"Reverse"}, 0},
+  {"GapHold", TUNE_DWELL, 5, 255, {"GapHold"}, 0},
+  {"SLIGHT_BAND", TUNE_PARAM, 500, 15000, {0}, ROBOT_SLIGHT_BAND},
+  {"STRONG_BAND", TUNE_PARAM, 5000, 33400, {0}, ROBOT_STRONG_BAND},
+  {"GAP_MM", TUNE_PARAM, 50, 400, {0}, ROBOT_GAP_MM},
+  {"ESTIMATOR_ALPHA", TUNE_PARAM, 16, 256, {0}, ROBOT_ESTIMATOR_ALPHA},
+  {"ESTIMATOR_BETA", TUNE_PARAM, 2, 128, {0}, ROBOT_ESTIMATOR_BETA},
+  {"GOVERNOR_MAX_DUTY", TUNE_PARAM, 5000, 15000, {0}, ROBOT_GOVERNOR_MAX_DUTY},
+  {"PROFILE_FAST", TUNE_PARAM, 5000, 15000, {0}, ROBOT_PROFILE_FAST},
+  {"PROFILE_SLOW", TUNE_PARAM, 2000, 12000, {0}, ROBOT_PROFILE_SLOW},
+};
+#define DIMS (sizeof(Dims)/sizeof(Dims[0]))
+
+typedef struct {
+  Param_t base;                   // world and start point
+  Param_t built;                  // the firmware's values the suite reads
+  uint32_t active[DIMS];          // dimensions searched, by Dims index
+  uint32_t n;
+  Course_t *course[TUNE_MAX_COURSES];
+  uint32_t courses, seeds, firstSeed, laps;
+  double lostMs;
+  Param_t *candidate;             // [population]
+  SimResult_t *result;            // [candidate][course][seed]
+} Tune_t;
+
+static void Tune_Job(void *arg, uint32_t i){
+  Tune_t *t = arg;
+  SimJob_t job;
+  job.param = &t->candidate[i/(t->courses*t->seeds)];
+  job.course = t->course[(i/t->seeds)%t->courses];
+  job.seed = t->firstSeed + i%t->seeds;
+  job.laps = t->laps;
+  job.limitMs = 30000*(t->laps + 1);
+  job.built = 0;
+  Sim_Run(&job, &t->result[i]);
+}
+
+static double Tune_RunCost(const Tune_t *t, const SimResult_t *r){
+  double cost = TUNE_MISS_MS*(double)(t->laps - r->laps) + t->lostMs*r->lostFrames;
+  uint32_t l;
+  for(l = 0; l < r->laps; l++){
+    cost += r->lapMs[l];
+  }
+  return cost;
+}
+
+// cost each of count candidates over the suite
+static void Tune_Cost(Tune_t *t, uint32_t threads, uint32_t count, double *cost){
+  uint32_t runs = t->courses*t->seeds, k, i;
+  Pool_Run(threads, count*runs, Tune_Job, t);
+  for(k = 0; k < count; k++){
+    cost[k] = 0;
+    for(i = 0; i < runs; i++){
+      cost[k] += Tune_RunCost(t, &t->result[k*runs + i]);
+    }
+    cost[k] /= runs;
+  }
+}
+
+// 1 if the firmware reads any field of dimension d on the suite
+static uint32_t Tune_Used(const Tune_t *t, const Dim_t *d){
+  uint32_t k;
+  int32_t s;
+  if(d->kind == TUNE_PARAM){
+    return t->built.paramSet[d->param];
+  }
+  for(k = 0; (k < TUNE_MAX_TARGETS) && d->state[k]; k++){
+    s = Param_State(d->state[k]);
+    if(t->built.set[s][ROBOT_LEFT] || t->built.set[s][ROBOT_DELAY]){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// |duty| of the faster wheel of a state
+static int32_t Tune_Top(const int32_t *field){
+  int32_t left = abs(field[ROBOT_LEFT]), right = abs(field[ROBOT_RIGHT]);
+  return (left > right) ? left : right;
+}
+
+// the start point's value of dimension d, from base over built
+static double Tune_Start(const Tune_t *t, const Dim_t *d){
+  double sum = 0;
+  uint32_t k, count = 0;
+  int32_t s;
+  if(d->kind == TUNE_PARAM){
+    return t->base.paramSet[d->param] ? t->base.param[d->param] : t->built.param[d->param];
+  }
+  for(k = 0; (k < TUNE_MAX_TARGETS) && d->state[k]; k++){
+    s = Param_State(d->state[k]);
+    if(d->kind == TUNE_DWELL){
+      if(t->built.set[s][ROBOT_DELAY]){
+        sum += t->base.set[s][ROBOT_DELAY] ? t->base.tune[s][ROBOT_DELAY] : t->built.tune[s][ROBOT_DELAY];
+        count++;
+      }
+    }else if(t->built.set[s][ROBOT_LEFT]){
+      sum += Tune_Top(t->base.set[s][ROBOT_LEFT] ? t->base.tune[s] : t->built.tune[s]);
+      count++;
+    }
+  }
+  return count ? sum/count : (d->lo + d->hi)/2;
+}
+
+// a point of the unit box as a parameter set
+static void Tune_Set(const Tune_t *t, const double *x, Param_t *p, const char *name){
+  uint32_t a, k, f;
+  int32_t s, v, top;
+  *p = t->base;
+  snprintf(p->name, PARAM_NAME, "%s", name);
+  for(a = 0; a < t->n; a++){
+    const Dim_t *d = &Dims[t->active[a]];
+    v = (int32_t)lround(d->lo + x[a]*(d->hi - d->lo));
+    if(d->kind == TUNE_PARAM){
+      p->param[d->param] = v;
+      p->paramSet[d->param] = 1;
+      continue;
+    }
+    for(k = 0; (k < TUNE_MAX_TARGETS) && d->state[k]; k++){
+      s = Param_State(d->state[k]);
+      top = Tune_Top(t->built.tune[s]);
+      for(f = 0; f < PARAM_FIELDS; f++){
+        if(((d->kind == TUNE_DWELL) != (f == ROBOT_DELAY)) || !t->built.set[s][f]){
+          continue;
+        }
+        if(d->kind == TUNE_DWELL){
+          p->tune[s][f] = v;
+        }else{
+          p->tune[s][f] = top ? (int32_t)lround((double)t->built.tune[s][f]*v/top) : 0;
+        }
+        p->set[s][f] = 1;
+      }
+    }
+  }
+}
+
+// the line courses of the library
+// Output: number opened, 0 if there are no course files yet
+static uint32_t Tune_Library(Tune_t *t){
+  glob_t files;
+  Course_t *c;
+  size_t i;
+  if(glob(TUNE_LIBRARY, 0, 0, &files) != 0){
+    return 0;
+  }
+  for(i = 0; (i < files.gl_pathc) && (t->courses < TUNE_MAX_COURSES); i++){
+    c = Course_Open(files.gl_pathv[i]);
+    if(c && (c->kind == COURSE_KIND_LINE)){
+      t->course[t->courses++] = c;
+    }else if(c){
+      Course_Free(c);
+    }
+  }
+  globfree(&files);
+  return t->courses;
+}
+
+static void Tune_Header(FILE *out, const Tune_t *t, const Param_t *p, double cost, double startCost){
+  uint32_t s, f, i;
+  fprintf(out, "// FsmTuned.h\n");
+  fprintf(out, "// Runs on MSP432\n");
+  fprintf(out, "// Written by sim/tune, do not edit.  Build with FSM_TUNED defined\n");
+  fprintf(out, "// to use these in place of the fsm[] outputs and dwells and the\n");
+  fprintf(out, "// constants below.  FSM_TUNED_KEEP keeps the fsm[] value.\n");
+  fprintf(out, "// Suite:");
+  for(i = 0; i < t->courses; i++){
+    fprintf(out, " %s", t->course[i]->name);
+  }
+  fprintf(out, ", %u seeds, %u laps\n", t->seeds, t->laps);
+  fprintf(out, "// Cost on fresh seeds %.0f, as built %.0f\n\n", cost, startCost);
+  fprintf(out, "#ifndef FSMTUNED_H_\n#define FSMTUNED_H_\n#include <stdint.h>\n\n");
+  fprintf(out, "#define FSM_TUNED_KEEP (-32768)\n\n");
+  fprintf(out, "// left, right, delay of each state, in fsm[] order\n");
+  fprintf(out, "static const int16_t FsmTuned[%u][3] = {\n", PARAM_STATES);
+  for(s = 0; s < PARAM_STATES; s++){
+    fprintf(out, "  {");
+    for(f = 0; f < PARAM_FIELDS; f++){
+      if(p->set[s][f]){
+        fprintf(out, "%s%d", f ? ", " : "", (int)p->tune[s][f]);
+      }else{
+        fprintf(out, "%sFSM_TUNED_KEEP", f ? ", " : "");
+      }
+    }
+    fprintf(out, "},  // %s\n", Param_StateName(s));
+  }
+  fprintf(out, "};\n");
+  fprintf(out, "#define ROBOT_TUNE(state, field, value) \\\n");
+  fprintf(out, "  ((FsmTuned[state][field] != FSM_TUNED_KEEP) ? FsmTuned[state][field] : (value))\n\n");
+  for(i = 0; i < ROBOT_PARAMS; i++){
+    if(p->paramSet[i]){
+      fprintf(out, "#define FSM_TUNED_ROBOT_%s(value) %d\n", Param_ParamName(i), (int)p->param[i]);
+    }else{
+      fprintf(out, "#define FSM_TUNED_ROBOT_%s(value) (value)\n", Param_ParamName(i));
+    }
+  }
+  fprintf(out, "#define ROBOT_PARAM(id, value) FSM_TUNED_##id(value)\n\n");
+  fprintf(out, "#endif\n");
+}
+
+int main(int argc, char **argv){
+  static Tune_t tune;
+  static Cma_t cma;
+  char courses[1024] = "";
+  char *name, line[8192];
+  const char *outName = 0;
+  uint32_t threads = 0, generations = 40, population = 0, g, k, a;
+  uint64_t seed = 1;
+  double x0[CMA_MAX_N], *cost, best = 1e300, check[2];
+  Param_t bestSet;
+  SimJob_t job;
+  SimResult_t r;
+  FILE *out = stdout;
+  int opt;
+  tune.seeds = 8;
+  tune.laps = 3;
+  tune.lostMs = 20;
+  Param_Default(&tune.base, "built");
+  while((opt = getopt(argc, argv, "j:s:l:c:g:p:w:r:o:")) != -1){
+    switch(opt){
+      case 'j': threads = strtoul(optarg, 0, 10); break;
+      case 's': tune.seeds = strtoul(optarg, 0, 10); break;
+      case 'l': tune.laps = strtoul(optarg, 0, 10); break;
+      case 'c': snprintf(courses, sizeof(courses), "%s", optarg); break;
+      case 'g': generations = strtoul(optarg, 0, 10); break;
+      case 'p': population = strtoul(optarg, 0, 10); break;
+      case 'w': tune.lostMs = strtod(optarg, 0); break;
+      case 'r': seed = strtoull(optarg, 0, 10); break;
+      case 'o': outName = optarg; break;
+      default:
+        fprintf(stderr, "usage: tune [-j threads] [-s seeds] [-l laps] [-c course,...] [-g generations]\n"
+                        "            [-p population] [-w ms] [-r seed] [-o FsmTuned.h] [base.txt]\n");
+        return 2;
+    }
+  }
+  if((tune.seeds == 0) || (tune.laps == 0) || (tune.laps > SIM_MAX_LAPS)){
+    fprintf(stderr, "seeds at least 1, laps 1 to %u\n", SIM_MAX_LAPS);
+    return 2;
+  }
+  if(optind < argc){
+    FILE *in = fopen(argv[optind], "r");
+    int got = 1;
+    if(in == 0){
+      perror(argv[optind]);
+      return 1;
+    }
+    while((got == 1) && fgets(line, sizeof(line), in)){
+      got = Param_Parse(&tune.base, line);
+    }
+    fclose(in);
+    if(got){
+      fprintf(stderr, "%s: no parameter set%s%s\n", argv[optind], (got < 0) ? ", bad key " : "",
+              (got < 0) ? tune.base.name : "");
+      return 1;
+    }
+  }
+  if((courses[0] == 0) && (Tune_Library(&tune) == 0)){
+    snprintf(courses, sizeof(courses), "%s", TUNE_BUILTIN);
+  }
+  for(name = strtok(courses, ","); name; name = strtok(0, ",")){
+    if(tune.courses == TUNE_MAX_COURSES){
+      fprintf(stderr, "more than %u courses\n", TUNE_MAX_COURSES);
+      return 1;
+    }
+    tune.course[tune.courses] = Course_Open(name);
+    if(tune.course[tune.courses] == 0){
+      return 1;
+    }
+    if(tune.course[tune.courses++]->kind != COURSE_KIND_LINE){
+      fprintf(stderr, "%s: a maze course, tune runs line courses\n", name);
+      return 1;
+    }
+  }
+
+  // which values the suite reads, and what they are as built
+  for(k = 0; k < tune.courses*tune.seeds; k++){
+    job.param = &tune.base;
+    job.course = tune.course[k/tune.seeds];
+    job.seed = 1 + k%tune.seeds;
+    job.laps = tune.laps;
+    job.limitMs = 30000*(tune.laps + 1);
+    job.built = &tune.built;
+    Sim_Run(&job, &r);
+  }
+  for(a = 0; a < DIMS; a++){
+    if(Tune_Used(&tune, &Dims[a]) && (tune.n < CMA_MAX_N)){
+      tune.active[tune.n] = a;
+      x0[tune.n] = (Tune_Start(&tune, &Dims[a]) - Dims[a].lo)/(Dims[a].hi - Dims[a].lo);
+      if(x0[tune.n] < 0) x0[tune.n] = 0;
+      if(x0[tune.n] > 1) x0[tune.n] = 1;
+      tune.n++;
+    }else{
+      fprintf(stderr, "kept %s, not read on this suite\n", Dims[a].name);
+    }
+  }
+  Cma_Init(&cma, tune.n, x0, 0.2, population, seed);
+  tune.candidate = calloc(cma.lambda, sizeof(Param_t));
+  tune.result = calloc((size_t)cma.lambda*tune.courses*tune.seeds, sizeof(SimResult_t));
+  cost = calloc(cma.lambda, sizeof(double));
+  if(!tune.candidate || !tune.result || !cost){
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  tune.firstSeed = 1;
+  Tune_Set(&tune, x0, &tune.candidate[0], "start");
+  Tune_Cost(&tune, threads, 1, cost);
+  best = cost[0];
+  bestSet = tune.candidate[0];
+  fprintf(stderr, "%u courses, %u dimensions, population %u, start cost %.0f\n",
+          tune.courses, tune.n, cma.lambda, best);
+
+  for(g = 0; g < generations; g++){
+    double mean = 0;
+    Cma_Ask(&cma);
+    for(k = 0; k < cma.lambda; k++){
+      Tune_Set(&tune, cma.x[k], &tune.candidate[k], "tuned");
+    }
+    Tune_Cost(&tune, threads, cma.lambda, cost);
+    for(k = 0; k < cma.lambda; k++){
+      mean += cost[k]/cma.lambda;
+      if(cost[k] < best){
+        best = cost[k];
+        bestSet = tune.candidate[k];
+      }
+    }
+    Cma_Tell(&cma, cost);
+    fprintf(stderr, "generation %u best %.0f mean %.0f sigma %.3f\n", g + 1, best, mean, cma.sigma);
+  }
+
+  // best against the start point on seeds the search never saw
+  tune.firstSeed = TUNE_CHECK_SEEDS;
+  tune.candidate[0] = bestSet;
+  Tune_Set(&tune, x0, &tune.candidate[1], "start");
+  Tune_Cost(&tune, threads, 2, check);
+  fprintf(stderr, "fresh seeds: tuned %.0f, start %.0f\n", check[0], check[1]);
+  Param_Write(&bestSet, line, sizeof(line));
+  fprintf(stderr, "%s\n", line);
+  if(check[0] >= check[1]){
+    fprintf(stderr, "no better than the start point on fresh seeds, nothing written\n");
+    return 1;
+  }
+  if(outName){
+    out = fopen(outName, "w");
+    if(out == 0){
+      perror(outName);
+      return 1;
+    }
+  }
+  Tune_Header(out, &tune, &bestSet, check[0], check[1]);
+  if(out != stdout){
+    fclose(out);
+  }
+  for(k = 0; k < tune.courses; k++){
+    Course_Free(tune.course[k]);
+  }
+  return 0;
+}
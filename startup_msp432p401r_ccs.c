@@ -35,6 +35,7 @@
 *****************************************************************************/
 
 #include <stdint.h>
+#include "Boot.h"
 
 /* Linker variable that marks the top of the stack. */
 extern unsigned long __STACK_END;
@@ -180,7 +181,10 @@ void (* const interruptVectors[])(void) =
 /* application.                                                                */
 void Reset_Handler(void)
 {
+    Boot_Start();                          /* time the boot from here  */
     SystemInit();
+    Boot_Mark(BOOT_SYSTEM);
+    Boot_Clock(BOOT_SYSTEM_MHZ);
 
     /* Jump to the CCS C Initialization Routine. */
     __asm("    .global _c_int00\n"
@@ -68,7 +68,12 @@
 //     <12000000> 12 MHz
 //     <24000000> 24 MHz
 //     <48000000> 48 MHz
+// FAST_BOOT starts at 48 MHz from the DCO, see Boot.h
+#ifdef FAST_BOOT
+#define  __SYSTEM_CLOCK    48000000
+#else
 #define  __SYSTEM_CLOCK    3000000
+#endif
 
 /*--------------------- Power Regulator Configuration -----------------------*/
 //  Power Regulator Mode
@@ -393,6 +398,10 @@ void SystemInit(void)
     CS->CTL0 = CS_CTL0_DCORSEL_5;                          // Set DCO to 48MHz
     CS->CTL1 = (CS->CTL1 & ~(CS_CTL1_SELM_MASK | CS_CTL1_DIVM_MASK)) | CS_CTL1_SELM__DCOCLK;  
 	                                                       // Select MCLK as DCO source
+    #ifdef FAST_BOOT
+    CS->CTL1 = (CS->CTL1 & ~(CS_CTL1_DIVS_MASK | CS_CTL1_DIVHS_MASK)) | CS_CTL1_DIVS__4 | CS_CTL1_DIVHS__2;
+                                                           // SMCLK 12 MHz, HSMCLK 24 MHz, as Clock_Init48MHz
+    #endif
     CS->KEY = 0;
 
     // Set Flash Bank read buffering
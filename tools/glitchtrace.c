@@ -0,0 +1,68 @@
+// glitchtrace.c
+// Runs on the host, not the robot
+// Runs a recorded reflectance trace through the same majority
+// filter the robot uses (ReflectFilter.c) and counts how often
+// the pattern changes, raw and filtered.  A blip is a pattern
+// that differs from the frames on both sides of it, the kind of
+// single-frame misread the filter is there to remove.
+//   glitchtrace [-v] [trace.txt]
+// The trace is one reflect_in value per frame in hex (0x18 or
+// 18), separated by white space or commas.  -v prints each
+// frame, raw and filtered, in binary.  sim/traces/wander.txt is
+// the trace sim/check holds the filter to: 149 blips raw, 8
+// filtered with the vote of 3.
+// Build with REFLECT_FILTER=5 (make REFLECT_FILTER=5) to try
+// a longer vote.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "../ReflectFilter.h"
+
+static void binary(uint8_t x){
+  int b;
+  for(b = 7; b >= 0; b--){
+    putchar((x & (1 << b)) ? '1' : '0');
+  }
+}
+
+int main(int argc, char **argv){
+  FILE *in = stdin;
+  ReflectFilter_t filter;
+  unsigned int value;
+  int i, verbose = 0;
+  uint32_t frames = 0;
+  uint8_t raw[3] = {0, 0, 0}, out[3] = {0, 0, 0};   // newest first
+  uint32_t rawChanges = 0, outChanges = 0, rawBlips = 0, outBlips = 0;
+  for(i = 1; i < argc; i++){
+    if(strcmp(argv[i], "-v") == 0){
+      verbose = 1;
+    }else if((in = fopen(argv[i], "r")) == NULL){
+      perror(argv[i]);
+      return 1;
+    }
+  }
+  Filter_Init(&filter);
+  while(fscanf(in, " %x ,", &value) == 1){
+    raw[2] = raw[1]; raw[1] = raw[0]; raw[0] = value;
+    out[2] = out[1]; out[1] = out[0]; out[0] = Filter_Majority(&filter, value);
+    if(verbose){
+      binary(raw[0]);
+      putchar(' ');
+      binary(out[0]);
+      putchar('\n');
+    }
+    frames++;
+    if(frames < 2) continue;
+    if(raw[0] != raw[1]) rawChanges++;
+    if(out[0] != out[1]) outChanges++;
+    if(frames < 3) continue;
+    if((raw[1] != raw[0]) && (raw[1] != raw[2])) rawBlips++;
+    if((out[1] != out[0]) && (out[1] != out[2])) outBlips++;
+  }
+  printf("%u frames, majority of %d\n", (unsigned)frames, REFLECT_FILTER);
+  printf("         changes  blips\n");
+  printf("raw      %7u  %5u\n", (unsigned)rawChanges, (unsigned)rawBlips);
+  printf("filtered %7u  %5u\n", (unsigned)outChanges, (unsigned)outBlips);
+  return 0;
+}
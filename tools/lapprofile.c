@@ -0,0 +1,79 @@
+// lapprofile.c
+// Runs on the host, not the robot
+// Turns a recorded lap into the speed profile the robot races.
+// Input is the learned Track.curvature table, one signed value
+// (-127 to 127) per PROFILE_SEGMENT_MM segment, separated by
+// white space or commas (a CCS memory export of Track.curvature
+// as decimal int8 works).  The profile is computed by the same
+// SpeedProfile.c the robot runs.
+//   lapprofile [-c] [lap.txt]
+// writes TrackProfile.h to stdout, build the robot with
+// TRACK_PRELOADED defined to race it from the first lap.
+//   -c  write CSV (segment, mm, curvature, duty) for plotting
+//       or for the simulator instead
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../SpeedProfile.h"
+
+static int8_t Curvature[PROFILE_MAX_SEGMENTS];
+static int16_t Speed[PROFILE_MAX_SEGMENTS];
+
+int main(int argc, char **argv){
+  FILE *in = stdin;
+  int csv = 0;
+  int i;
+  uint32_t n = 0;
+  long value;
+  int c;
+  for(i = 1; i < argc; i++){
+    if(strcmp(argv[i], "-c") == 0){
+      csv = 1;
+    }else if((in = fopen(argv[i], "r")) == NULL){
+      perror(argv[i]);
+      return 1;
+    }
+  }
+  while((c = fgetc(in)) != EOF){
+    if((c == ',') || (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n')){
+      continue;
+    }
+    ungetc(c, in);
+    if(fscanf(in, "%ld", &value) != 1){
+      fprintf(stderr, "lapprofile: bad value after segment %u\n", (unsigned)n);
+      return 1;
+    }
+    if(n == PROFILE_MAX_SEGMENTS){
+      fprintf(stderr, "lapprofile: lap longer than %d segments\n", PROFILE_MAX_SEGMENTS);
+      return 1;
+    }
+    if(value > 127) value = 127;
+    if(value < -127) value = -127;
+    Curvature[n++] = (int8_t)value;
+  }
+  if(n == 0){
+    fprintf(stderr, "lapprofile: empty lap\n");
+    return 1;
+  }
+  SpeedProfile_Compute(Curvature, n, Speed);
+  if(csv){
+    printf("segment,mm,curvature,duty\n");
+    for(i = 0; i < (int)n; i++){
+      printf("%d,%d,%d,%d\n", i, i*PROFILE_SEGMENT_MM, Curvature[i], Speed[i]);
+    }
+    return 0;
+  }
+  printf("// TrackProfile.h\n");
+  printf("// Generated by tools/lapprofile from a recorded lap, do not edit\n");
+  printf("// %u segments of %d mm\n\n", (unsigned)n, PROFILE_SEGMENT_MM);
+  printf("#ifndef TRACKPROFILE_H_\n#define TRACKPROFILE_H_\n#include <stdint.h>\n\n");
+  printf("#define TRACK_PROFILE_SEGMENTS %u\n\n", (unsigned)n);
+  printf("static const int16_t TrackProfile[TRACK_PROFILE_SEGMENTS]={");
+  for(i = 0; i < (int)n; i++){
+    printf("%s%s%d", i ? "," : "", (i % 12) ? " " : "\n  ", Speed[i]);
+  }
+  printf("\n};\n\n#endif\n");
+  return 0;
+}